@@ -1,8 +1,85 @@
 #pragma once
 #include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace epistemic {
 
+// Agents are small dense indices; per-agent data lives in vectors
+// indexed by Agent.
 using Agent = std::uint32_t;
 
+/**
+ * Set of agents as a bitmask: bit i is agent i. Groups are limited
+ * to the first 64 agents.
+ */
+using AgentMask = std::uint64_t;
+
+constexpr std::uint32_t kMaxGroupAgents = 64;
+
+constexpr AgentMask agent_bit(Agent a) {
+  return AgentMask{1} << a;
+}
+
+/**
+ * Lowest agent in a non-empty mask.
+ */
+inline Agent lowest_agent(AgentMask mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<Agent>(__builtin_ctzll(mask));
+#else
+  Agent a = 0;
+  while (!(mask & agent_bit(a))) ++a;
+  return a;
+#endif
+}
+
+/**
+ * Call f(a) for every agent a in mask, in increasing order.
+ */
+template <typename F>
+void for_each_agent(AgentMask mask, F&& f) {
+  for (; mask != 0; mask &= mask - 1) {
+    f(lowest_agent(mask));
+  }
+}
+
+/**
+ * Maps external agent names to contiguous Agent indices.
+ */
+class AgentRegistry {
+public:
+  Agent add(const std::string& name) {
+    auto it = index_.find(name);
+    if (it != index_.end()) return it->second;
+
+    const Agent a = static_cast<Agent>(names_.size());
+    names_.push_back(name);
+    index_.emplace(name, a);
+    return a;
+  }
+
+  Agent index(const std::string& name) const {
+    auto it = index_.find(name);
+    if (it == index_.end()) {
+      throw std::runtime_error("Unknown agent: " + name);
+    }
+    return it->second;
+  }
+
+  bool contains(const std::string& name) const {
+    return index_.count(name) != 0;
+  }
+
+  const std::string& name(Agent a) const { return names_.at(a); }
+
+  std::size_t size() const { return names_.size(); }
+
+private:
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, Agent> index_;
+};
+
 } // namespace epistemic
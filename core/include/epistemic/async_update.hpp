@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <memory>
+
+#include "belief_state.hpp"
+#include "event_model.hpp"
+#include "thread_pool.hpp"
+
+namespace epistemic {
+
+/**
+ * Shared cancellation flag. Copies refer to the same flag.
+ */
+class CancellationToken {
+public:
+  CancellationToken()
+    : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+  void cancel() const { flag_->store(true); }
+  bool cancelled() const { return flag_->load(); }
+
+private:
+  std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+struct UpdateOptions {
+  using Clock = std::chrono::steady_clock;
+
+  Clock::time_point deadline = Clock::time_point::max();
+
+  // At the deadline, hand out the latest partial snapshot instead of
+  // giving up, and keep computing the full update in the background.
+  bool anytime = false;
+
+  // Cap on worlds in a partial snapshot (highest-weight first); 0 = none.
+  std::size_t max_partial_worlds = 0;
+
+  CancellationToken cancel;
+};
+
+struct UpdateResult {
+  BeliefState state;
+
+  // False for a partial (anytime) result, a missed deadline or when
+  // cancelled.
+  bool complete = true;
+  bool cancelled = false;
+
+  // Not in anytime mode and the deadline passed first; the update was
+  // abandoned. The caller's cancellation token is left untouched.
+  bool deadline_missed = false;
+};
+
+struct AsyncUpdate {
+  /**
+   * Ready by the deadline, even if the task has not started: the full
+   * update if it finished in time; otherwise, in anytime mode, the
+   * latest partial snapshot flagged incomplete (empty if none was
+   * built yet); otherwise an empty result flagged deadline_missed.
+   */
+  std::future<UpdateResult> result;
+
+  /**
+   * Ready when the full update finishes, is cancelled, or is abandoned
+   * at a missed deadline (not anytime).
+   */
+  std::shared_future<UpdateResult> completion;
+
+  CancellationToken cancel;
+};
+
+/**
+ * Product update as a task on `pool`.
+ *
+ * Candidate product worlds (w,e) are accepted in order of decreasing
+ * event weight, so a partial result holds the most plausible worlds.
+ * In anytime mode a partial snapshot is rebuilt each time the accepted
+ * candidates double, keeping the extra work linear; its edges are
+ * those of the full product restricted to its worlds. The full product
+ * is built once. Inputs are copied. The task holds one pool worker
+ * until `completion` is ready; a deadline also arms a watchdog thread
+ * that sends `result` when it passes.
+ */
+AsyncUpdate product_update_async(
+  BeliefState belief,
+  EventModel event_model,
+  ThreadPool& pool,
+  UpdateOptions options = {}
+);
+
+} // namespace epistemic
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "world.hpp"
+#include "quadtree_map.hpp"
 #include "formula.hpp"
 
 namespace epistemic {
@@ -9,13 +10,48 @@ namespace epistemic {
  * Interpret an atomic proposition in a given world.
  *
  * e.g.
+ *  - "true"
  *  - "cell_free(3,4)"
- *  - "agent_at(robot, x, y)"
- *  - "goal_reached(robot)"
+ *  - "region_free(x0,y0,x1,y1)"       (inclusive cell rectangle)
+ *  - "unknown_at_most(x0,y0,x1,y1,k)"
+ *  - "lidar_bin_7"                    (needs an ActiveScan)
+ *  - "agent_at(a,x,y)"                 (agent index a is in cell (x, y))
  */
 bool interpret_atom(
   const World& world,
   const Atom& atom
 );
 
+/**
+ * Parsed "agent_at(a,x,y)". Holds where agent a has a pose inside the
+ * half-open box [x0, x1) x [y0, y1] of map cell (x, y); the box is in
+ * meters for the given resolution, so per-world and PoseTable
+ * evaluation compare the same doubles.
+ */
+struct AgentAtAtom {
+  Agent agent;
+  int x;
+  int y;
+
+  double x0(double resolution) const { return x * resolution; }
+  double y0(double resolution) const { return y * resolution; }
+  double x1(double resolution) const { return (x + 1) * resolution; }
+  double y1(double resolution) const { return (y + 1) * resolution; }
+};
+
+/** False if the atom is not a well-formed agent_at. */
+bool parse_agent_at(
+  const Atom& atom,
+  AgentAtAtom& out
+);
+
+/**
+ * The map atoms above (cell_free, region_free, unknown_at_most, and
+ * "true") evaluated on a quadtree map; anything else is false.
+ */
+bool interpret_atom(
+  const QuadtreeMap& map,
+  const Atom& atom
+);
+
 } // namespace epistemic
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "belief_state.hpp"
+#include "formula.hpp"
+#include "thread_pool.hpp"
+
+namespace epistemic {
+
+/**
+ * Truth table of a formula batch over the designated worlds.
+ * Row f, column i is `holds(belief, worlds[i], *formulas[f])`.
+ */
+struct BatchResult {
+  std::vector<WorldId> worlds;
+  std::size_t formula_count = 0;
+
+  // Row-major, formula_count x worlds.size()
+  std::vector<std::uint8_t> values;
+
+  bool at(std::size_t f, std::size_t i) const {
+    return values[f * worlds.size() + i] != 0;
+  }
+
+  /**
+   * Same answer as holds_in_all for formula f.
+   */
+  bool holds_in_all(std::size_t f) const {
+    for (std::size_t i = 0; i < worlds.size(); ++i) {
+      if (!at(f, i)) return false;
+    }
+    return true;
+  }
+};
+
+/**
+ * Evaluate many formulas over all designated worlds in one pass.
+ *
+ * Structurally equal subformulas (formula_equal) are evaluated once
+ * for the whole batch. Subformulas are processed bottom-up by height;
+ * each height level is spread over the pool by (subformula, world
+ * chunk). Agrees with `holds` world by world.
+ */
+BatchResult holds_batch(
+  const BeliefState& belief,
+  const std::vector<const Formula*>& formulas,
+  ThreadPool& pool
+);
+
+} // namespace epistemic
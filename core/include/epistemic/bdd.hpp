@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace epistemic {
+
+using BddVar = std::uint32_t;
+
+// Node handle inside a BddManager. 0 is false, 1 is true.
+using BddRef = std::uint32_t;
+
+constexpr BddRef kBddFalse = 0;
+constexpr BddRef kBddTrue = 1;
+
+/**
+ * Minimal reduced ordered BDD package.
+ *
+ * Variables are ordered by index. Nodes are hash-consed and never
+ * freed; call clear_caches() between large queries to bound the
+ * operation caches.
+ */
+class BddManager {
+public:
+  BddManager();
+
+  BddRef var(BddVar v);
+  BddRef nvar(BddVar v);
+
+  BddRef negate(BddRef f);
+  BddRef apply_and(BddRef f, BddRef g);
+  BddRef apply_or(BddRef f, BddRef g);
+  BddRef ite(BddRef f, BddRef g, BddRef h);
+
+  /**
+   * Conjunction of the given variables, used as a quantifier cube.
+   */
+  BddRef cube(const std::vector<BddVar>& vars);
+
+  // ∃ vars(cube). f
+  BddRef exists(BddRef f, BddRef cube);
+
+  // ∃ vars(cube). f ∧ g  (relational product)
+  BddRef and_exists(BddRef f, BddRef g, BddRef cube);
+
+  /**
+   * Substitute variable v by map[v] (variables not in map are kept).
+   */
+  BddRef rename(BddRef f, const std::vector<BddVar>& map);
+
+  /**
+   * Number of satisfying assignments over variables [0, nvars).
+   */
+  long double sat_count(BddRef f, BddVar nvars);
+
+  /**
+   * Evaluate f under a full assignment indexed by variable.
+   */
+  bool eval(BddRef f, const std::vector<bool>& assignment) const;
+
+  std::size_t node_count() const { return nodes_.size(); }
+
+  void clear_caches();
+
+private:
+  struct Node {
+    BddVar var;
+    BddRef lo;
+    BddRef hi;
+  };
+
+  struct Key3 {
+    std::uint64_t a;
+    std::uint64_t b;
+
+    bool operator==(const Key3& o) const { return a == o.a && b == o.b; }
+  };
+
+  struct Key3Hash {
+    std::size_t operator()(const Key3& k) const {
+      return static_cast<std::size_t>(
+        k.a * 0x9e3779b97f4a7c15ULL ^ (k.b + (k.a >> 29))
+      );
+    }
+  };
+
+  BddVar top(BddRef f) const { return nodes_[f].var; }
+
+  BddRef mk(BddVar v, BddRef lo, BddRef hi);
+
+  BddRef low(BddRef f, BddVar v) const {
+    return top(f) == v ? nodes_[f].lo : f;
+  }
+
+  BddRef high(BddRef f, BddVar v) const {
+    return top(f) == v ? nodes_[f].hi : f;
+  }
+
+  BddRef rename_rec(
+    BddRef f,
+    const std::vector<BddVar>& map,
+    std::unordered_map<BddRef, BddRef>& memo
+  );
+
+  long double sat_count_rec(
+    BddRef f,
+    BddVar nvars,
+    std::unordered_map<BddRef, long double>& memo
+  );
+
+  std::vector<Node> nodes_;
+  std::unordered_map<Key3, BddRef, Key3Hash> unique_;
+
+  // Operation caches, keyed by (op|f, g|h).
+  std::unordered_map<Key3, BddRef, Key3Hash> ite_cache_;
+  std::unordered_map<Key3, BddRef, Key3Hash> quant_cache_;
+};
+
+} // namespace epistemic
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "belief_state.hpp"
+#include "fingerprint.hpp"
+
+namespace epistemic {
+
+/**
+ * Consecutive cells [start, start + length) set to one state.
+ */
+struct CellRun {
+  std::uint32_t start;
+  std::uint32_t length;
+  CellState state;
+};
+
+/**
+ * A world expressed as changes against a parent world.
+ *
+ * Without a parent, the cells are relative to an all-Unknown map of
+ * the given size. Cells are diffed in dense form whatever the world's
+ * MapStorage, and worlds built from a delta are stored dense. Poses
+ * and goals are always sent whole (they are a handful of entries).
+ */
+struct WorldDelta {
+  WorldId id;
+
+  bool has_parent = false;
+  WorldId parent = 0;
+
+  std::uint32_t width = 0;
+  std::uint32_t height = 0;
+  double resolution = 0.0;
+
+  std::vector<CellRun> cells;
+
+  std::vector<std::pair<Agent, Pose>> poses;
+  std::vector<std::pair<Agent, std::string>> goals;
+};
+
+struct EdgeChange {
+  Agent agent;
+  WorldId from;
+  WorldId to;
+};
+
+/**
+ * Difference between two belief states.
+ */
+struct BeliefDelta {
+  // belief_digest of the states the delta goes from / to. Worlds are
+  // patched by id, so a bisimulation-invariant fingerprint would
+  // accept states the delta does not fit.
+  Fingerprint base = 0;
+  Fingerprint target = 0;
+
+  std::vector<WorldDelta> added;
+  std::vector<WorldDelta> modified; // parent is the world itself
+  std::vector<WorldId> removed;
+
+  std::vector<EdgeChange> edges_added;
+  std::vector<EdgeChange> edges_removed;
+
+  std::vector<WorldId> designated_added;
+  std::vector<WorldId> designated_removed;
+};
+
+/**
+ * Delta turning `from` into `to`.
+ *
+ * A new world uses the world it was produced from as parent when that
+ * world is in `from` (product ids keep it in the upper 32 bits), so a
+ * product update costs only the cells the event changed.
+ */
+BeliefDelta diff_beliefs(
+  const BeliefState& from,
+  const BeliefState& to
+);
+
+/**
+ * Apply a delta in place. Bumps the version.
+ *
+ * With `verify`, checks the base digest first and the target digest
+ * after applying, and throws std::runtime_error on either mismatch;
+ * `state` is then left unchanged.
+ */
+void apply_delta(
+  BeliefState& state,
+  const BeliefDelta& delta,
+  bool verify = true
+);
+
+/**
+ * Largest map (width * height) a decoded delta may describe.
+ */
+constexpr std::uint64_t kMaxDeltaCells = std::uint64_t{1} << 28;
+
+/**
+ * Largest total map area across all added and modified worlds of one
+ * delta, so many small messages cannot each claim a full-size map.
+ */
+constexpr std::uint64_t kMaxDeltaTotalCells = kMaxDeltaCells;
+
+/**
+ * Compact binary form: LEB128 varints, ids delta-coded, doubles as
+ * IEEE-754 little-endian.
+ */
+std::vector<std::uint8_t> encode_delta(const BeliefDelta& delta);
+
+/**
+ * @throws std::runtime_error on truncated or malformed input, including
+ * values that overflow their field, maps above kMaxDeltaCells and
+ * deltas whose maps together exceed kMaxDeltaTotalCells
+ */
+BeliefDelta decode_delta(const std::uint8_t* data, std::size_t size);
+
+/**
+ * In-process transport for exercising belief sync without a network.
+ */
+class LoopbackTransport {
+public:
+  void send(std::vector<std::uint8_t> message) {
+    bytes_sent_ += message.size();
+    queue_.push_back(std::move(message));
+  }
+
+  std::optional<std::vector<std::uint8_t>> receive() {
+    if (queue_.empty()) return std::nullopt;
+    auto message = std::move(queue_.front());
+    queue_.pop_front();
+    return message;
+  }
+
+  std::size_t bytes_sent() const { return bytes_sent_; }
+
+private:
+  std::deque<std::vector<std::uint8_t>> queue_;
+  std::size_t bytes_sent_ = 0;
+};
+
+} // namespace epistemic
@@ -1,13 +1,23 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <cstddef>
+#include <cstdint>
 
 #include "world.hpp"
 #include "kripke_model.hpp"
 
 namespace epistemic {
 
+/**
+ * Process-wide monotonically increasing belief version counter.
+ * Version 0 is never handed out.
+ */
+inline std::uint64_t next_belief_version() {
+  static std::atomic<std::uint64_t> counter{0};
+  return ++counter;
+}
 
 // A belief state = Kripke model + designated worlds.
 struct BeliefState {
@@ -16,6 +26,27 @@ struct BeliefState {
   // Current possible worlds
   std::vector<WorldId> designated;
 
+  // Identifies this state for derived caches (see QueryCache).
+  // Updates and copies stamp a fresh version, since a copy may be
+  // edited in place; moves keep it.
+  std::uint64_t version = next_belief_version();
+
+  BeliefState() = default;
+
+  BeliefState(const BeliefState& other)
+    : model(other.model), designated(other.designated) {}
+
+  BeliefState(BeliefState&&) = default;
+
+  BeliefState& operator=(const BeliefState& other) {
+    model = other.model;
+    designated = other.designated;
+    touch();
+    return *this;
+  }
+
+  BeliefState& operator=(BeliefState&&) = default;
+
   bool empty() const {
     return designated.empty();
   }
@@ -23,6 +54,14 @@ struct BeliefState {
   std::size_t size() const {
     return designated.size();
   }
+
+  /**
+   * Call after mutating the model or designated set in place,
+   * so caches keyed on the old version are not reused.
+   */
+  void touch() {
+    version = next_belief_version();
+  }
 };
 
 } // namespace epistemic
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "belief_state.hpp"
+
+namespace epistemic {
+
+inline std::uint64_t chunk_mix(std::uint64_t z) {
+  z += 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// Entry hashes for ChunkedVector; other entry types provide an
+// overload found by argument-dependent lookup.
+inline std::uint64_t chunk_item_hash(WorldId id) {
+  return chunk_mix(id);
+}
+
+inline std::uint64_t chunk_item_hash(const std::pair<WorldId, WorldId>& edge) {
+  return chunk_mix(chunk_mix(edge.first) ^ edge.second);
+}
+
+/**
+ * Content-addressed store of immutable chunks: equal chunks built by
+ * any snapshot resolve to one shared copy while some snapshot holds it.
+ */
+template <typename T>
+class ChunkPool {
+public:
+  using Chunk = std::vector<T>;
+
+  std::shared_ptr<const Chunk> intern(
+    std::uint64_t hash,
+    Chunk&& chunk
+  ) {
+    auto [begin, end] = chunks_.equal_range(hash);
+    for (auto it = begin; it != end; ++it) {
+      auto stored = it->second.lock();
+      if (stored && *stored == chunk) return stored;
+    }
+
+    auto stored = std::make_shared<const Chunk>(std::move(chunk));
+    chunks_.emplace(hash, stored);
+    return stored;
+  }
+
+  /** Forget chunks no snapshot holds any more. */
+  void prune() {
+    for (auto it = chunks_.begin(); it != chunks_.end();) {
+      it = it->second.expired() ? chunks_.erase(it) : std::next(it);
+    }
+  }
+
+private:
+  std::unordered_multimap<std::uint64_t, std::weak_ptr<const Chunk>> chunks_;
+};
+
+/**
+ * Immutable vector stored as chunks behind shared pointers.
+ *
+ * Chunk boundaries are content-defined: a chunk ends after an entry
+ * whose hash has its low bits clear (between kMinChunk and kMaxChunk
+ * entries), so inserting or removing entries only changes the chunks
+ * around the edit and the boundaries after it fall where they did
+ * before. build() with a pool interns every chunk by content, so
+ * versions that differ in a few entries share the rest wherever the
+ * equal runs sit.
+ */
+template <typename T>
+class ChunkedVector {
+public:
+  static constexpr std::size_t kMinChunk = 16;
+  static constexpr std::size_t kMaxChunk = 256;
+  static constexpr std::uint64_t kBoundaryMask = 63;
+
+  using Chunk = std::vector<T>;
+
+  ChunkedVector() = default;
+
+  static ChunkedVector build(
+    const std::vector<T>& items,
+    ChunkPool<T>* pool = nullptr
+  ) {
+    ChunkedVector out;
+    out.size_ = items.size();
+
+    std::size_t begin = 0;
+    std::uint64_t hash = 0;
+
+    for (std::size_t i = 0; i < items.size(); ++i) {
+      const std::uint64_t h = chunk_item_hash(items[i]);
+      hash = chunk_mix(hash ^ h);
+
+      const std::size_t length = i + 1 - begin;
+      const bool boundary =
+        (length >= kMinChunk && (h & kBoundaryMask) == 0) ||
+        length == kMaxChunk ||
+        i + 1 == items.size();
+      if (!boundary) continue;
+
+      Chunk chunk(items.begin() + begin, items.begin() + i + 1);
+      out.chunks_.push_back(pool
+        ? pool->intern(hash, std::move(chunk))
+        : std::make_shared<const Chunk>(std::move(chunk)));
+      out.ends_.push_back(i + 1);
+
+      begin = i + 1;
+      hash = 0;
+    }
+    return out;
+  }
+
+  std::size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  /** O(log chunks). */
+  const T& operator[](std::size_t i) const {
+    const std::size_t k =
+      std::upper_bound(ends_.begin(), ends_.end(), i) - ends_.begin();
+    const std::size_t first = k == 0 ? 0 : ends_[k - 1];
+    return (*chunks_[k])[i - first];
+  }
+
+  template <typename F>
+  void for_each(F&& f) const {
+    for (const auto& chunk : chunks_) {
+      for (const T& item : *chunk) f(item);
+    }
+  }
+
+  std::vector<T> to_vector() const {
+    std::vector<T> out;
+    out.reserve(size_);
+    for (const auto& chunk : chunks_) {
+      out.insert(out.end(), chunk->begin(), chunk->end());
+    }
+    return out;
+  }
+
+  const std::vector<std::shared_ptr<const Chunk>>& chunks() const {
+    return chunks_;
+  }
+
+private:
+  std::vector<std::shared_ptr<const Chunk>> chunks_;
+  std::vector<std::size_t> ends_;  // one past each chunk's last entry
+  std::size_t size_ = 0;
+};
+
+/**
+ * A world slot in a snapshot. The World itself is interned by content,
+ * so its own id is whichever id it was first committed under.
+ */
+struct StoredWorld {
+  WorldId id;
+  std::shared_ptr<const World> world;
+
+  bool operator==(const StoredWorld& other) const {
+    return id == other.id && world == other.world;
+  }
+};
+
+inline std::uint64_t chunk_item_hash(const StoredWorld& slot) {
+  return chunk_mix(chunk_mix(slot.id) ^
+    static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(slot.world.get())));
+}
+
+/**
+ * One committed belief state. Immutable, and shares worlds and chunks
+ * with the snapshots around it.
+ */
+struct BeliefSnapshot {
+  std::uint64_t revision = 0;
+  std::uint64_t parent = 0;   // 0 = first commit
+
+  // BeliefState::version of the committed state; materialize() keeps
+  // it, so caches keyed on it stay valid across a rollback.
+  std::uint64_t version = 0;
+
+  ChunkedVector<StoredWorld> worlds;
+  std::vector<ChunkedVector<std::pair<WorldId, WorldId>>> accessibility;
+  ChunkedVector<WorldId> designated;
+};
+
+struct BeliefStoreStats {
+  std::size_t revisions = 0;
+  std::size_t distinct_worlds = 0;
+  std::size_t chunks = 0;
+
+  // Worlds and chunks, each counted once however many revisions
+  // share it.
+  std::size_t bytes = 0;
+};
+
+/**
+ * Versioned history of belief states with structural sharing.
+ *
+ * Each commit interns its worlds by content (world_content_hash, then
+ * World::operator==), so a world that survives an update, or a product
+ * world that copies its parent unchanged, is stored once. World slots,
+ * relations and designated sets are split into content-defined chunks
+ * interned in per-store pools, so any run of entries equal to one in a
+ * kept revision is stored once, even if it moved. Keeping N revisions
+ * therefore costs the worlds and chunks that actually changed plus one
+ * chunk index per revision.
+ *
+ * Rollback only moves the head. Commits after a rollback branch from
+ * it; the abandoned revisions stay reachable until trimmed.
+ *
+ * Not synchronized.
+ */
+class PersistentBeliefStore {
+public:
+  /** max_revisions = 0 keeps every revision. */
+  explicit PersistentBeliefStore(std::size_t max_revisions = 0)
+    : max_revisions_(max_revisions) {}
+
+  /**
+   * Record `state` as a child of the head and make it the head.
+   * Worlds are moved out of `state`. Costs one content hash per world
+   * and a full comparison per hash hit.
+   */
+  std::uint64_t commit(BeliefState state);
+
+  /**
+   * Make an earlier revision the head, in O(1). Returns false if the
+   * revision was never committed or has been trimmed.
+   */
+  bool rollback(std::uint64_t revision);
+
+  /** nullptr before the first commit. */
+  std::shared_ptr<const BeliefSnapshot> head() const { return head_; }
+
+  /** nullptr if unknown or trimmed. */
+  std::shared_ptr<const BeliefSnapshot> snapshot(std::uint64_t revision) const;
+
+  /**
+   * Rebuild a full BeliefState. This copies every map; readers that
+   * only need a few worlds can walk the snapshot instead.
+   */
+  static BeliefState materialize(const BeliefSnapshot& snapshot);
+
+  /** @throws std::out_of_range if the revision is unknown or trimmed */
+  BeliefState materialize(std::uint64_t revision) const;
+
+  /** Oldest revision still kept, or 0 when empty. */
+  std::uint64_t first_revision() const {
+    return revisions_.empty() ? 0 : revisions_.front()->revision;
+  }
+
+  std::size_t size() const { return revisions_.size(); }
+
+  BeliefStoreStats stats() const;
+
+private:
+  std::shared_ptr<const World> intern(World&& w);
+
+  void trim();
+
+  std::size_t max_revisions_;
+  std::uint64_t next_revision_ = 1;
+
+  // Consecutive revisions, oldest first
+  std::deque<std::shared_ptr<const BeliefSnapshot>> revisions_;
+  std::shared_ptr<const BeliefSnapshot> head_;
+
+  // world_content_hash -> worlds held by some snapshot
+  std::unordered_multimap<std::uint64_t, std::weak_ptr<const World>> pool_;
+
+  ChunkPool<StoredWorld> world_chunks_;
+  ChunkPool<std::pair<WorldId, WorldId>> edge_chunks_;
+  ChunkPool<WorldId> designated_chunks_;
+};
+
+} // namespace epistemic
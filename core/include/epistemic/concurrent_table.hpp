@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+
+namespace epistemic {
+
+/**
+ * Fixed-capacity lock-free hash table from 64-bit fingerprints to
+ * 64-bit values, for visited-state detection and caching across
+ * search threads.
+ *
+ * Open addressing with linear probing; slots are claimed by CAS on
+ * the key and never freed. Key 0 is remapped internally and value
+ * UINT64_MAX is reserved. Throws std::runtime_error when full; owners
+ * that can pause writers grow it with rehash().
+ */
+class ConcurrentFingerprintTable {
+public:
+  explicit ConcurrentFingerprintTable(std::size_t capacity) {
+    std::size_t cap = 16;
+    while (cap < capacity) cap <<= 1;
+
+    mask_ = cap - 1;
+    slots_ = std::make_unique<Entry[]>(cap);
+  }
+
+  /**
+   * Insert key -> value unless key is present.
+   * @return true if this call inserted the key
+   */
+  bool insert(std::uint64_t key, std::uint64_t value) {
+    const Claim c = claim(key);
+    if (c.inserted) {
+      c.entry->value.store(value, std::memory_order_release);
+    }
+    return c.inserted;
+  }
+
+  /**
+   * Insert key -> value, or lower the stored value to `value`.
+   * @return true if the stored value is now `value` (new or improved)
+   */
+  bool insert_or_min(std::uint64_t key, std::uint64_t value) {
+    const Claim c = claim(key);
+    if (c.inserted) {
+      c.entry->value.store(value, std::memory_order_release);
+      return true;
+    }
+
+    std::uint64_t current = wait_value(*c.entry);
+    while (value < current) {
+      if (c.entry->value.compare_exchange_weak(
+            current, value, std::memory_order_acq_rel)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::optional<std::uint64_t> find(std::uint64_t key) const {
+    key = remap(key);
+    std::size_t i = hash(key) & mask_;
+
+    for (std::size_t probes = 0; probes <= mask_; ++probes) {
+      const Entry& e = slots_[i];
+      const std::uint64_t k = e.key.load(std::memory_order_acquire);
+
+      if (k == key) return wait_value(e);
+      if (k == kEmpty) return std::nullopt;
+
+      i = (i + 1) & mask_;
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * Move every entry into a table of at least `capacity` slots.
+   * Not safe concurrently with any other call.
+   */
+  void rehash(std::size_t capacity) {
+    ConcurrentFingerprintTable bigger(std::max(capacity, size() + 1));
+
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      const std::uint64_t k = slots_[i].key.load(std::memory_order_relaxed);
+      if (k == kEmpty) continue;
+
+      // Stored keys are already remapped, and remap leaves them as is.
+      const Claim c = bigger.claim(k);
+      c.entry->value.store(
+        slots_[i].value.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    }
+
+    slots_ = std::move(bigger.slots_);
+    mask_ = bigger.mask_;
+  }
+
+  std::size_t size() const { return size_.load(std::memory_order_relaxed); }
+  std::size_t capacity() const { return mask_ + 1; }
+
+private:
+  static constexpr std::uint64_t kEmpty = 0;
+  static constexpr std::uint64_t kPending = ~std::uint64_t{0};
+
+  struct Entry {
+    std::atomic<std::uint64_t> key{kEmpty};
+    std::atomic<std::uint64_t> value{kPending};
+  };
+
+  struct Claim {
+    Entry* entry;
+    bool inserted;
+  };
+
+  static std::uint64_t remap(std::uint64_t key) {
+    return key == kEmpty ? 0x9e3779b97f4a7c15ULL : key;
+  }
+
+  static std::size_t hash(std::uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return static_cast<std::size_t>(key);
+  }
+
+  static std::uint64_t wait_value(const Entry& e) {
+    // The inserter stores the value right after winning the key CAS.
+    std::uint64_t v;
+    while ((v = e.value.load(std::memory_order_acquire)) == kPending) {
+    }
+    return v;
+  }
+
+  // Find the slot for key, claiming an empty one if needed.
+  Claim claim(std::uint64_t key) {
+    key = remap(key);
+    std::size_t i = hash(key) & mask_;
+
+    for (std::size_t probes = 0; probes <= mask_; ++probes) {
+      Entry& e = slots_[i];
+      std::uint64_t k = e.key.load(std::memory_order_acquire);
+
+      if (k == kEmpty) {
+        if (e.key.compare_exchange_strong(
+              k, key, std::memory_order_acq_rel)) {
+          size_.fetch_add(1, std::memory_order_relaxed);
+          return {&e, true};
+        }
+        // Lost the race; k now holds the winner's key.
+      }
+      if (k == key) return {&e, false};
+
+      i = (i + 1) & mask_;
+    }
+
+    throw std::runtime_error("ConcurrentFingerprintTable is full");
+  }
+
+  std::unique_ptr<Entry[]> slots_;
+  std::size_t mask_ = 0;
+  std::atomic<std::size_t> size_{0};
+};
+
+} // namespace epistemic
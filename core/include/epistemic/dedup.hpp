@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+#include "belief_state.hpp"
+
+namespace epistemic {
+
+enum class DedupMode {
+  // Merge worlds with equal map, poses and goals. Exact for atoms, but
+  // may merge worlds that differ in what agents know.
+  Content,
+
+  // Merge only worlds that are also bisimilar: every formula keeps its
+  // truth value.
+  Bisimulation
+};
+
+struct DedupStats {
+  std::size_t worlds_before = 0;
+  std::size_t worlds_after = 0;
+};
+
+/**
+ * Merge structurally identical worlds of a belief.
+ *
+ * Candidates are bucketed by content hash (and, for Bisimulation, by
+ * bisimulation class) and confirmed with World::operator==. Each class
+ * keeps its first world's id; edges and designated entries of the
+ * others are redirected to it and de-duplicated. The default mode
+ * preserves every formula; Content must be asked for explicitly.
+ */
+BeliefState deduplicate_worlds(
+  const BeliefState& belief,
+  DedupMode mode = DedupMode::Bisimulation,
+  DedupStats* stats = nullptr
+);
+
+} // namespace epistemic
@@ -1,14 +1,51 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
 
 #include "belief_state.hpp"
 #include "event_model.hpp"
 
 namespace epistemic {
+
+/**
+ * Product update: world (w, e) for every designated w and event e
+ * whose precondition holds there, with id (w << 32) | e.
+ *
+ * The ids keep the source world for one update only; chained updates
+ * shift its high bits out and distinct worlds collide. Callers that
+ * update an update's result call renumber_worlds in between.
+ */
 BeliefState product_update(
   const BeliefState& B,
   const EventModel& E
 );
 
-} // namespace epistemic
\ No newline at end of file
+/**
+ * Product update with preconditions decided by `pre(w, e)` instead of
+ * `holds`, for events whose preconditions were tabulated up front.
+ */
+BeliefState product_update(
+  const BeliefState& B,
+  const EventModel& E,
+  const std::function<bool(WorldId, const Event&)>& pre
+);
+
+/**
+ * Give the worlds ids 0 .. n-1 in model order and remap designated and
+ * edges. Edges and designated ids naming no world (product_update
+ * leaves edges to non-designated worlds dangling) are dropped. Bumps
+ * the version.
+ */
+void renumber_worlds(BeliefState& B);
+
+/**
+ * Public announcement of phi: keeps the designated worlds where
+ * phi holds, and the edges between them.
+ */
+BeliefState public_announcement(
+  const BeliefState& B,
+  const Formula& phi
+);
+
+} // namespace epistemic
@@ -0,0 +1,132 @@
+#ifndef EPISTEMIC_EVALUATION_PLANNER_HPP
+#define EPISTEMIC_EVALUATION_PLANNER_HPP
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "formula.hpp"
+#include "kripke_model.hpp"
+
+namespace epistemic {
+
+/**
+ * @brief Observed behaviour of one subformula
+ */
+struct SubformulaStats {
+    std::size_t evaluations = 0;
+    std::size_t true_count = 0;
+    std::size_t visits = 0;  ///< Nodes visited in total while evaluating it
+    
+    double truth_rate() const {
+        return evaluations ? static_cast<double>(true_count) / evaluations : 0.5;
+    }
+    
+    double mean_cost() const {
+        return evaluations ? static_cast<double>(visits) / evaluations : 0.0;
+    }
+};
+
+/**
+ * @brief Adaptive evaluator that short-circuits ∧/∨ chains cheapest-first
+ *
+ * Evaluates formulas like Formula::evaluate, but treats each ∧ (or ∨)
+ * chain as one commutative list and tries its operands in increasing
+ * order of cost / P(short-circuit). Costs start from a static estimate
+ * (modal operators multiply their body's cost by the average out-degree
+ * of the relation, or by the world count for C_G), taken against the
+ * model of the evaluation that triggers the reordering, and switch to
+ * the measured mean once an operand has enough samples; truth rates
+ * come from the same samples. Orders are revised every reorder_interval
+ * evaluations of a chain.
+ *
+ * The planner keeps its own copy of every goal it evaluates, found by
+ * structure, and shares statistics between structurally equal
+ * subformulas, so they carry over between goal objects and never refer
+ * to the caller's formulas. Not thread-safe; use one planner per thread.
+ */
+class EvaluationPlanner {
+public:
+    /**
+     * @param reorder_interval Chain evaluations between reorderings
+     * @param min_samples Samples before measured costs replace estimates
+     */
+    explicit EvaluationPlanner(std::size_t reorder_interval = 64, std::size_t min_samples = 16);
+    
+    /**
+     * @brief Evaluate phi at a world, recording statistics
+     */
+    bool evaluate(const KripkeModel& model, const Formula& phi, const std::string& world);
+    
+    /**
+     * @brief Static cost estimate of phi in a model, in node visits
+     */
+    static double estimate_cost(const KripkeModel& model, const Formula& phi);
+    
+    /**
+     * @brief Statistics for a subformula, or nullptr if never evaluated
+     *
+     * Looked up by structure, pooled over every occurrence in the goals
+     * evaluated so far.
+     */
+    const SubformulaStats* stats(const Formula& phi) const;
+    
+    /**
+     * @brief Total node visits so far
+     */
+    std::size_t visits() const { return visits_; }
+    
+    /**
+     * @brief Forget all statistics and orders
+     */
+    void reset();
+    
+private:
+    struct Operand {
+        const Formula* formula;
+        bool negated;  ///< From the left side of an implication
+    };
+    
+    struct Chain {
+        bool conjunction;
+        std::vector<Operand> operands;
+        std::size_t evaluations = 0;
+    };
+    
+    bool eval(const KripkeModel& model, const Formula& phi, const std::string& world);
+    bool eval_node(const KripkeModel& model, const Formula& phi, const std::string& world);
+    bool eval_chain(const KripkeModel& model, const Formula& phi, const std::string& world);
+    
+    /// The planner's copy of a goal, cloned on first sight
+    const Formula& own(const Formula& phi);
+    
+    /// Attach every node of an owned goal to the statistics of its
+    /// structural class; returns the node's structural hash
+    std::size_t index_nodes(const Formula& phi);
+    
+    Chain& chain_for(const Formula& phi);
+    void reorder(const KripkeModel& model, Chain& chain) const;
+    
+    std::size_t reorder_interval_;
+    std::size_t min_samples_;
+    std::size_t visits_ = 0;
+    
+    // Owned goals; every pointer below points into them
+    std::vector<std::unique_ptr<Formula>> goals_;
+    std::unordered_multimap<std::size_t, const Formula*> goal_index_;
+    
+    // One representative node per structural class, and each owned
+    // node's class statistics
+    std::unordered_multimap<std::size_t, const Formula*> node_index_;
+    std::deque<SubformulaStats> stats_pool_;
+    std::unordered_map<const Formula*, SubformulaStats*> stats_;
+    
+    std::unordered_map<const Formula*, Chain> chains_;
+};
+
+} // namespace epistemic
+
+#endif // EPISTEMIC_EVALUATION_PLANNER_HPP
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <unordered_map>
 #include <vector>
 
 #include "agent.hpp"
@@ -14,6 +13,9 @@ namespace epistemic {
 struct Event {
   std::size_t id;
   Formula precondition;
+
+  // Relative plausibility; anytime updates build heavier events first.
+  double weight = 1.0;
 };
 
 /**
@@ -22,21 +24,33 @@ struct Event {
 struct EventModel {
   std::vector<Event> events;
 
-  // R^E_a ⊆ Event × Event
-  std::unordered_map<
-    Agent,
+  // R^E_a ⊆ Event × Event, indexed by agent
+  std::vector<
     std::vector<std::pair<std::size_t, std::size_t>>
   > accessibility;
 
-  bool accessible(
+  void add_edge(
     Agent a,
     std::size_t e1,
     std::size_t e2
+  ) {
+    if (a >= accessibility.size()) accessibility.resize(a + 1);
+    accessibility[a].push_back({e1, e2});
+  }
+
+  const std::vector<std::pair<std::size_t, std::size_t>>& relation(
+    Agent a
   ) const {
-    auto it = accessibility.find(a);
-    if (it == accessibility.end()) return false;
+    static const std::vector<std::pair<std::size_t, std::size_t>> none;
+    return a < accessibility.size() ? accessibility[a] : none;
+  }
 
-    for (const auto& [from, to] : it->second) {
+  bool accessible(
+    Agent a,
+    std::size_t e1,
+    std::size_t e2
+  ) const {
+    for (const auto& [from, to] : relation(a)) {
       if (from == e1 && to == e2) return true;
     }
     return false;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "belief_state.hpp"
+
+namespace epistemic {
+
+using Fingerprint = std::uint64_t;
+
+/**
+ * Hash of what a world says (map, poses, goals), ignoring its id and
+ * its MapStorage.
+ */
+std::uint64_t world_content_hash(const World& w);
+
+/**
+ * Canonical fingerprint of a belief state.
+ *
+ * Invariant under renaming of world ids and, since it hashes the
+ * coarsest stable colouring of the designated worlds (iterated
+ * refinement over successor colour *sets*, per agent), under
+ * bisimulation: bisimilar states always get the same fingerprint.
+ * Distinct states collide only by 64-bit hash collision.
+ */
+Fingerprint belief_fingerprint(const BeliefState& belief);
+
+/**
+ * Hash of the exact state: world ids with their contents, edges and
+ * designated ids. Unlike belief_fingerprint it changes when worlds are
+ * renamed; only the order of the vectors is ignored.
+ */
+Fingerprint belief_digest(const BeliefState& belief);
+
+/**
+ * The same refinement over every world of the model: worlds with equal
+ * colours are bisimilar, up to hash collision.
+ */
+std::unordered_map<WorldId, Fingerprint> bisimulation_colors(
+  const BeliefState& belief
+);
+
+} // namespace epistemic
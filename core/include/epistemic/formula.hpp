@@ -5,11 +5,15 @@
 #include <memory>
 #include <set>
 
+#include "agent.hpp"
+
 namespace epistemic {
 
 class KripkeModel;
 
 enum class FormulaType {
+    TOP,
+    BOTTOM,
     ATOM,
     NOT,
     AND,
@@ -17,7 +21,8 @@ enum class FormulaType {
     IMPLIES,
     KNOWS,
     COMMON_KNOWLEDGE,
-    EVERYBODY_KNOWS
+    EVERYBODY_KNOWS,
+    DISTRIBUTED_KNOWLEDGE
 };
 
 /**
@@ -40,6 +45,28 @@ public:
     virtual std::unique_ptr<Formula> clone() const = 0;
 };
 
+/**
+ * @brief Constant true: ⊤
+ */
+class Top : public Formula {
+public:
+    bool evaluate(const KripkeModel&, const std::string&) const override { return true; }
+    FormulaType get_type() const override { return FormulaType::TOP; }
+    std::string to_string() const override { return "⊤"; }
+    std::unique_ptr<Formula> clone() const override;
+};
+
+/**
+ * @brief Constant false: ⊥
+ */
+class Bottom : public Formula {
+public:
+    bool evaluate(const KripkeModel&, const std::string&) const override { return false; }
+    FormulaType get_type() const override { return FormulaType::BOTTOM; }
+    std::string to_string() const override { return "⊥"; }
+    std::unique_ptr<Formula> clone() const override;
+};
+
 /**
  * @brief Atomic proposition
  */
@@ -70,6 +97,8 @@ public:
     std::string to_string() const override;
     std::unique_ptr<Formula> clone() const override;
     
+    const Formula& get_subformula() const { return *subformula_; }
+    
 private:
     std::unique_ptr<Formula> subformula_;
 };
@@ -86,6 +115,9 @@ public:
     std::string to_string() const override;
     std::unique_ptr<Formula> clone() const override;
     
+    const Formula& get_left() const { return *left_; }
+    const Formula& get_right() const { return *right_; }
+    
 private:
     std::unique_ptr<Formula> left_;
     std::unique_ptr<Formula> right_;
@@ -103,6 +135,9 @@ public:
     std::string to_string() const override;
     std::unique_ptr<Formula> clone() const override;
     
+    const Formula& get_left() const { return *left_; }
+    const Formula& get_right() const { return *right_; }
+    
 private:
     std::unique_ptr<Formula> left_;
     std::unique_ptr<Formula> right_;
@@ -120,6 +155,9 @@ public:
     std::string to_string() const override;
     std::unique_ptr<Formula> clone() const override;
     
+    const Formula& get_left() const { return *left_; }
+    const Formula& get_right() const { return *right_; }
+    
 private:
     std::unique_ptr<Formula> left_;
     std::unique_ptr<Formula> right_;
@@ -127,37 +165,44 @@ private:
 
 /**
  * @brief Knowledge operator: K_agent(φ)
+ * The agent is an index (see KripkeModel::agent_index), resolved once
+ * when the formula is built rather than at every evaluation
  */
 class Knows : public Formula {
 public:
-    Knows(const std::string& agent, std::unique_ptr<Formula> subformula);
+    Knows(Agent agent, std::unique_ptr<Formula> subformula);
     
     bool evaluate(const KripkeModel& model, const std::string& world) const override;
     FormulaType get_type() const override { return FormulaType::KNOWS; }
     std::string to_string() const override;
     std::unique_ptr<Formula> clone() const override;
     
-    const std::string& get_agent() const { return agent_; }
+    Agent get_agent() const { return agent_; }
+    const Formula& get_subformula() const { return *subformula_; }
     
 private:
-    std::string agent_;
+    Agent agent_;
     std::unique_ptr<Formula> subformula_;
 };
 
 /**
  * @brief Common knowledge: C_Group(φ)
+ * The group is a bitmask of agent indices (see KripkeModel::agent_mask)
  */
 class CommonKnowledge : public Formula {
 public:
-    CommonKnowledge(const std::set<std::string>& group, std::unique_ptr<Formula> subformula);
+    CommonKnowledge(AgentMask group, std::unique_ptr<Formula> subformula);
     
     bool evaluate(const KripkeModel& model, const std::string& world) const override;
     FormulaType get_type() const override { return FormulaType::COMMON_KNOWLEDGE; }
     std::string to_string() const override;
     std::unique_ptr<Formula> clone() const override;
     
+    AgentMask get_group() const { return group_; }
+    const Formula& get_subformula() const { return *subformula_; }
+    
 private:
-    std::set<std::string> group_;
+    AgentMask group_;
     std::unique_ptr<Formula> subformula_;
 };
 
@@ -167,26 +212,63 @@ private:
  */
 class EverybodyKnows : public Formula {
 public:
-    EverybodyKnows(const std::set<std::string>& group, std::unique_ptr<Formula> subformula);
+    EverybodyKnows(AgentMask group, std::unique_ptr<Formula> subformula);
     
     bool evaluate(const KripkeModel& model, const std::string& world) const override;
     FormulaType get_type() const override { return FormulaType::EVERYBODY_KNOWS; }
     std::string to_string() const override;
     std::unique_ptr<Formula> clone() const override;
     
+    AgentMask get_group() const { return group_; }
+    const Formula& get_subformula() const { return *subformula_; }
+    
 private:
-    std::set<std::string> group_;
+    AgentMask group_;
     std::unique_ptr<Formula> subformula_;
 };
 
+/**
+ * @brief Distributed knowledge: D_Group(φ)
+ * D_G(φ) holds iff φ holds in every world that all agents in G consider
+ * possible, i.e. what G would know by pooling its information
+ */
+class DistributedKnowledge : public Formula {
+public:
+    DistributedKnowledge(AgentMask group, std::unique_ptr<Formula> subformula);
+    
+    bool evaluate(const KripkeModel& model, const std::string& world) const override;
+    FormulaType get_type() const override { return FormulaType::DISTRIBUTED_KNOWLEDGE; }
+    std::string to_string() const override;
+    std::unique_ptr<Formula> clone() const override;
+    
+    AgentMask get_group() const { return group_; }
+    const Formula& get_subformula() const { return *subformula_; }
+    
+private:
+    AgentMask group_;
+    std::unique_ptr<Formula> subformula_;
+};
+
+std::unique_ptr<Formula> make_true();
+std::unique_ptr<Formula> make_false();
 std::unique_ptr<Formula> make_atom(const std::string& proposition);
 std::unique_ptr<Formula> make_not(std::unique_ptr<Formula> phi);
 std::unique_ptr<Formula> make_and(std::unique_ptr<Formula> left, std::unique_ptr<Formula> right);
 std::unique_ptr<Formula> make_or(std::unique_ptr<Formula> left, std::unique_ptr<Formula> right);
 std::unique_ptr<Formula> make_implies(std::unique_ptr<Formula> left, std::unique_ptr<Formula> right);
-std::unique_ptr<Formula> make_knows(const std::string& agent, std::unique_ptr<Formula> phi);
-std::unique_ptr<Formula> make_common_knowledge(const std::set<std::string>& group, std::unique_ptr<Formula> phi);
-std::unique_ptr<Formula> make_everybody_knows(const std::set<std::string>& group, std::unique_ptr<Formula> phi);
+std::unique_ptr<Formula> make_knows(Agent agent, std::unique_ptr<Formula> phi);
+
+/**
+ * @brief K_agent(φ) for a named agent of model
+ * @throws std::runtime_error if the agent is unknown
+ */
+std::unique_ptr<Formula> make_knows(
+    const KripkeModel& model,
+    const std::string& agent,
+    std::unique_ptr<Formula> phi);
+std::unique_ptr<Formula> make_common_knowledge(AgentMask group, std::unique_ptr<Formula> phi);
+std::unique_ptr<Formula> make_everybody_knows(AgentMask group, std::unique_ptr<Formula> phi);
+std::unique_ptr<Formula> make_distributed_knowledge(AgentMask group, std::unique_ptr<Formula> phi);
 
 } // namespace epistemic
 
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+#include "agent.hpp"
+#include "formula.hpp"
+
+namespace epistemic {
+
+/**
+ * Text syntax for goals and event preconditions:
+ *
+ *   phi := phi & phi | !phi | K[a] phi | D[a,b,...] phi | (phi) | atom
+ *
+ * where a is an agent index and atom is any name interpret_atom
+ * understands, e.g. cell_free(3,4) or true. Atom arguments are kept
+ * verbatim.
+ *
+ * @throws std::invalid_argument on a syntax error
+ */
+Formula parse_formula(const std::string& text);
+
+/**
+ * A bracketed agent list on its own, "[a,b,...]".
+ *
+ * @throws std::invalid_argument on a syntax error
+ */
+AgentMask parse_agent_group(const std::string& text);
+
+} // namespace epistemic
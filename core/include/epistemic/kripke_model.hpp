@@ -4,15 +4,34 @@
 
 #include <string>
 #include <set>
+#include <cstdint>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <memory>
 
+#include "agent.hpp"
+
 namespace epistemic {
 
 // Forward declaration
 class Formula;
 
+/**
+ * @brief Approximate bytes held by a KripkeModel, by component
+ *
+ * Tree nodes are estimated at their value size plus four pointers;
+ * strings count their heap buffer when it exceeds the small-string size.
+ */
+struct KripkeMemoryUsage {
+    std::size_t worlds = 0;
+    std::size_t relations = 0;
+    std::size_t valuations = 0;
+    
+    std::size_t total() const { return worlds + relations + valuations; }
+};
+
 /**
  * @brief Represents a Kripke model for epistemic reasoning
  * 
@@ -25,7 +44,8 @@ class Formula;
 struct KripkeModel {
       /**
        * @brief Construct a new Kripke Model with given agents
-       * @param agents Set of agent identifiers
+       * @param agents Set of agent identifiers. Agents are indexed in
+       *        sorted order, which fixes the bits used in AgentMask groups.
        */
       explicit KripkeModel(const std::set<std::string>& agents);
       
@@ -37,9 +57,36 @@ struct KripkeModel {
       
       /**
        * @brief Remove a world from the model
+       *
+       * Removing the current world leaves no current world
+       * (get_current_world() is empty) until set_current_world().
+       *
        * @param world_id Identifier for the world to remove
+       * @return true if world_id was the current world
+       */
+      bool remove_world(const std::string& world_id);
+      
+      /**
+       * @brief Remove many worlds at once
+       *
+       * Marks the worlds dead, then compacts valuations and every agent's
+       * relation in a single pass, instead of one full sweep per world.
+       * Unknown identifiers are ignored. As with remove_world, removing
+       * the current world leaves no current world.
+       *
+       * @param world_ids Range of world identifiers to remove
+       * @return true if the current world was among them
        */
-      void remove_world(const std::string& world_id);
+      template <typename Range>
+      bool remove_worlds(const Range& world_ids) {
+          std::unordered_set<std::string> dead;
+          for (const auto& world_id : world_ids) {
+              if (worlds_.count(world_id)) {
+                  dead.insert(world_id);
+              }
+          }
+          return remove_dead_worlds(dead);
+      }
       
       /**
        * @brief Add accessibility relation between worlds for an agent
@@ -100,6 +147,15 @@ struct KripkeModel {
           const Formula& phi
       ) const;
       
+      /**
+       * @brief Evaluate K_agent(phi) for an agent index
+       */
+      bool evaluate_knows(
+          const std::string& world,
+          Agent agent,
+          const Formula& phi
+      ) const;
+      
       /**
        * @brief Get all worlds accessible to agent from given world
        * @param agent Agent identifier
@@ -114,40 +170,125 @@ struct KripkeModel {
       /**
        * @brief Evaluate common knowledge for a group of agents
        * @param world Current world
-       * @param group Set of agent identifiers
+       * @param group Bitmask of agent indices
        * @param phi Formula to check for common knowledge
        * @return true if group has common knowledge of phi at world
        */
       bool evaluate_common_knowledge(
           const std::string& world,
-          const std::set<std::string>& group,
+          AgentMask group,
+          const Formula& phi
+      ) const;
+      
+      /**
+       * @brief Evaluate distributed knowledge for a group of agents
+       *
+       * phi must hold at every world that all agents in the group consider
+       * possible. Walks the smallest of the group's successor sets and
+       * looks each world up in the others, without building the
+       * intersection relation.
+       *
+       * @param world Current world
+       * @param group Bitmask of agent indices
+       * @param phi Formula to check
+       * @return true if the group has distributed knowledge of phi at world
+       */
+      bool evaluate_distributed_knowledge(
+          const std::string& world,
+          AgentMask group,
           const Formula& phi
       ) const;
       
       /**
        * @brief Get all worlds reachable by group through accessibility relations
        * @param start_world Starting world
-       * @param group Set of agent identifiers
+       * @param group Bitmask of agent indices
        * @return Set of reachable worlds
        */
       std::set<std::string> get_group_reachable_worlds(
           const std::string& start_world,
-          const std::set<std::string>& group
+          AgentMask group
+      ) const;
+      
+      /**
+       * @brief Successors of a world for an agent index
+       * @return Accessible worlds, or nullptr if there are none
+       */
+      const std::set<std::string>* successors(
+          Agent agent,
+          const std::string& world
       ) const;
       
+      /**
+       * @brief Number of edges in an agent's accessibility relation
+       */
+      std::size_t relation_size(Agent agent) const;
+      
+      /**
+       * @brief Whether an agent's relation is an equivalence relation
+       *
+       * Checked as: every world reaches itself, and every successor of a
+       * world has exactly that world's successor set.
+       */
+      bool is_equivalence(Agent agent) const;
+      
+      /**
+       * @brief Whether every agent's relation is an equivalence relation
+       */
+      bool is_s5() const;
+      
+      /**
+       * @brief Index of a named agent
+       * @throws std::runtime_error if the agent is unknown
+       */
+      Agent agent_index(const std::string& agent) const {
+          return registry_.index(agent);
+      }
+      
+      /**
+       * @brief Bitmask of a set of named agents
+       * @throws std::runtime_error if an agent is unknown
+       */
+      AgentMask agent_mask(const std::set<std::string>& agents) const;
+      
       /**
        * @brief Apply public announcement (removes worlds where phi is false)
        * @param phi Formula being announced
+       * @return false if phi was false at the current world, which is
+       *         then removed and left unset (the announcement was untruthful)
        */
-      void public_announcement(const Formula& phi);
+      bool public_announcement(const Formula& phi);
       
       /**
        * @brief Apply private observation by an agent
+       *
+       * The agent learns whether phi holds: its edges between worlds that
+       * disagree on phi are dropped, in place. Other agents are unchanged.
+       *
        * @param agent Agent making the observation
        * @param phi Formula being observed
        */
       void private_observation(const std::string& agent, const Formula& phi);
       
+      /**
+       * @brief Apply a private announcement of phi to an agent (DEL product update)
+       *
+       * Product with the event model {e: phi, s: true} where the agent
+       * tells e and s apart and every other agent only considers s.
+       * Every world w stays as (w,s), so the other agents' view is kept
+       * intact; each phi-world also gets a copy (w,e) named w', w'', ...
+       * The current world moves to its e-copy if phi holds there.
+       *
+       * @param agent Agent receiving the announcement
+       * @param phi Formula being announced
+       */
+      void private_announcement(const std::string& agent, const Formula& phi);
+      
+      /**
+       * @brief Approximate memory held by the model
+       */
+      KripkeMemoryUsage memory_usage() const;
+      
       /**
        * @brief Clone the model
        * @return Deep copy of this model
@@ -168,11 +309,25 @@ struct KripkeModel {
       void set_current_world(const std::string& world) { current_world_ = world; }
       
   private:
+      bool remove_dead_worlds(const std::unordered_set<std::string>& dead);
+      
+      // Position of each world in worlds_ order
+      std::unordered_map<std::string, std::size_t> world_ordinals() const;
+      
+      // Bit i is set iff phi holds at the i-th world (worlds_ order)
+      std::vector<std::uint64_t> extension_bits(
+          const Formula& phi,
+          const std::unordered_map<std::string, std::size_t>& ordinals
+      ) const;
+      
+      std::string fresh_world_name(const std::string& base) const;
+      
       std::set<std::string> worlds_;
       std::set<std::string> agents_;
+      AgentRegistry registry_;
       
-      // accessibility_[agent][from_world] = set of accessible worlds
-      std::map<std::string, std::map<std::string, std::set<std::string>>> accessibility_;
+      // accessibility_[agent index][from_world] = set of accessible worlds
+      std::vector<std::map<std::string, std::set<std::string>>> accessibility_;
       
       // valuation_[world][proposition] = truth value
       std::map<std::string, std::map<std::string, bool>> valuation_;
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "belief_state.hpp"
+#include "event_model.hpp"
+
+namespace epistemic {
+
+/**
+ * Approximate heap + inline bytes, by component. Container slack
+ * (capacity beyond size) is included; hash-node overhead is estimated.
+ */
+struct MemoryReport {
+  std::size_t worlds = 0;      // World records and the worlds vector
+  std::size_t maps = 0;        // occupancy cells, edit logs, quadtrees
+  std::size_t map_caches = 0;  // summed-area tables, distance fields
+  std::size_t poses = 0;
+  std::size_t goals = 0;
+  std::size_t relations = 0;
+  std::size_t designated = 0;
+  std::size_t formulas = 0;    // event preconditions
+
+  std::size_t total() const {
+    return worlds + maps + map_caches + poses + goals +
+           relations + designated + formulas;
+  }
+};
+
+MemoryReport measure_memory(const BeliefState& belief);
+
+MemoryReport measure_memory(const EventModel& events);
+
+/** Bytes of a formula tree; shared subformulas count once per use. */
+std::size_t formula_bytes(const Formula& phi);
+
+/**
+ * Hard memory limit for a belief state and what may be done to meet it.
+ */
+struct MemoryBudget {
+  std::size_t max_bytes = 0;  // 0 = unlimited
+
+  bool allow_deduplicate = true;
+  bool allow_prune = true;
+
+  // Pruning drops the lowest-scoring designated worlds first. The
+  // default keeps earlier hypotheses over later ones.
+  std::function<double(const World&)> score;
+};
+
+struct BudgetResult {
+  MemoryReport before;
+  MemoryReport after;
+
+  std::size_t merged_worlds = 0;
+  std::size_t pruned_worlds = 0;
+
+  bool within_budget = true;
+};
+
+/**
+ * Bring a belief under budget, cheapest step first:
+ *  1. compact: drop map caches, unreachable worlds, duplicate edges
+ *     and container slack (no change in meaning);
+ *  2. merge bisimilar duplicate worlds (no change in meaning);
+ *  3. prune designated worlds by score (loses hypotheses).
+ * Stops as soon as the belief fits.
+ */
+BudgetResult enforce_budget(
+  BeliefState& belief,
+  const MemoryBudget& budget
+);
+
+} // namespace epistemic
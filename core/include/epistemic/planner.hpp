@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "belief_state.hpp"
+#include "event_model.hpp"
+#include "formula.hpp"
+#include "thread_pool.hpp"
+
+namespace epistemic {
+
+/**
+ * A planning action: an event model applied by product update.
+ */
+struct Action {
+  std::string name;
+  EventModel event;
+  double cost = 1.0;
+};
+
+/**
+ * Action from its text form. "name: phi" is a public announcement of
+ * phi. "name[a,b,...]: phi" is a sensing action: agents a, b, ... learn
+ * whether phi holds and everyone else only that they did. phi uses the
+ * parse_formula syntax.
+ *
+ * @throws std::invalid_argument on a malformed spec
+ */
+Action parse_action(
+  const std::string& spec,
+  std::size_t agent_count
+);
+
+/**
+ * Estimated remaining cost from a belief state. Must be >= 0;
+ * admissible heuristics keep A* plans optimal. Called concurrently
+ * from pool threads.
+ */
+using Heuristic = std::function<double(const BeliefState&)>;
+
+enum class SearchStrategy {
+  BreadthFirst,
+  AStar,
+  GreedyBestFirst
+};
+
+struct PlannerOptions {
+  SearchStrategy strategy = SearchStrategy::BreadthFirst;
+
+  // Unset means h = 0 (A* degrades to uniform cost search).
+  Heuristic heuristic;
+
+  std::size_t max_expansions = 100000;
+  std::size_t max_depth = 32;
+
+  // Best-first: nodes popped and expanded together per round.
+  // 0 picks the pool size.
+  std::size_t batch_size = 0;
+
+  // Prune successors whose belief_fingerprint was already reached
+  // at no greater cost.
+  bool detect_duplicates = true;
+
+  // Initial transposition table slots; 0 picks a small default. The
+  // table grows before each round to stay at most half full.
+  std::size_t table_capacity = 0;
+};
+
+struct PlanResult {
+  bool found = false;
+
+  // Indices into the planner's action list, in execution order.
+  std::vector<std::size_t> actions;
+  double cost = 0.0;
+
+  std::size_t expanded = 0;
+  std::size_t generated = 0;
+  std::size_t duplicates = 0;
+};
+
+/**
+ * Forward search over belief states.
+ *
+ * Successors come from product_update, renumbered with renumber_worlds
+ * so ids stay unique at any depth; an action is applicable when its
+ * update leaves at least one designated world. Goals are checked
+ * with holds_in_all. Each round expands a set of frontier nodes,
+ * with every (node, action) pair running as a task on the pool.
+ * Duplicate states are detected across tasks through a shared
+ * lock-free transposition table keyed by belief_fingerprint.
+ *
+ * With batch_size > 1, A* expands several nodes per round, so the
+ * first plan found is optimal only up to that batch.
+ */
+class Planner {
+public:
+  Planner(std::vector<Action> actions, ThreadPool& pool);
+
+  PlanResult plan(
+    const BeliefState& initial,
+    const Formula& goal,
+    const PlannerOptions& options = {}
+  ) const;
+
+  const std::vector<Action>& actions() const { return actions_; }
+
+private:
+  PlanResult breadth_first(
+    const BeliefState& initial,
+    const Formula& goal,
+    const PlannerOptions& options
+  ) const;
+
+  PlanResult best_first(
+    const BeliefState& initial,
+    const Formula& goal,
+    const PlannerOptions& options
+  ) const;
+
+  std::vector<Action> actions_;
+  ThreadPool& pool_;
+};
+
+/**
+ * Number of designated worlds in which goal does not hold.
+ * Cheap and informative for greedy search; not admissible. Keeps its
+ * own copy of goal.
+ */
+Heuristic unsatisfied_worlds_heuristic(Formula goal);
+
+} // namespace epistemic
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "belief_state.hpp"
+
+namespace epistemic {
+
+using GoalId = std::uint32_t;
+
+inline constexpr GoalId kNoGoal = ~GoalId{0};
+
+/**
+ * Structure-of-arrays view of every agent's pose and goal across the
+ * worlds of a belief.
+ *
+ * Columns are agent-major: x, y and theta of agent a over all worlds
+ * are contiguous, so a per-agent scan over worlds is a straight loop
+ * over doubles the compiler can vectorize. Missing poses are NaN and
+ * fail every comparison. Goals are interned to GoalIds.
+ *
+ * Rows follow model.worlds order; world_id(row) maps back. The table
+ * is a snapshot: it records the belief version it was built from, and
+ * matches() turns false once the belief is touched or updated.
+ */
+class PoseTable {
+public:
+  PoseTable() = default;
+
+  explicit PoseTable(const BeliefState& belief);
+
+  std::size_t world_count() const { return ids_.size(); }
+  std::size_t agent_count() const { return agents_; }
+
+  /** Version of the belief this table was built from. */
+  std::uint64_t version() const { return version_; }
+
+  /** False once `belief` has changed since the table was built. */
+  bool matches(const BeliefState& belief) const {
+    return version_ == belief.version;
+  }
+
+  WorldId world_id(std::size_t row) const {
+    assert(row < ids_.size());
+    return ids_[row];
+  }
+
+  bool has_pose(std::size_t row, Agent a) const;
+  Pose pose(std::size_t row, Agent a) const;
+
+  /** Column of agent a; a must be below agent_count(). */
+  const double* xs(Agent a) const { return x_.data() + column(a); }
+  const double* ys(Agent a) const { return y_.data() + column(a); }
+  const double* thetas(Agent a) const { return theta_.data() + column(a); }
+
+  void set_pose(std::size_t row, Agent a, const Pose& p);
+
+  GoalId goal(std::size_t row, Agent a) const;
+  void set_goal(std::size_t row, Agent a, const std::string& goal);
+
+  /** Interned id of a goal, or kNoGoal if no world has it. */
+  GoalId goal_id(const std::string& goal) const;
+  const std::string& goal_name(GoalId id) const { return goal_names_[id]; }
+
+  /**
+   * One byte per row: 1 where agent a is within radius r of (px, py).
+   */
+  std::vector<std::uint8_t> within_mask(
+    Agent a,
+    double px,
+    double py,
+    double r
+  ) const;
+
+  /**
+   * One byte per row: 1 where agent a lies in the half-open box
+   * [x0, x1) x [y0, y1].
+   */
+  std::vector<std::uint8_t> box_mask(
+    Agent a,
+    double x0,
+    double y0,
+    double x1,
+    double y1
+  ) const;
+
+  /** Ids of the worlds where agent a is within r of (px, py). */
+  std::vector<WorldId> worlds_within(
+    Agent a,
+    double px,
+    double py,
+    double r
+  ) const;
+
+  /** Ids of the worlds where agent a has the given goal. */
+  std::vector<WorldId> worlds_with_goal(
+    Agent a,
+    GoalId goal
+  ) const;
+
+private:
+  std::size_t column(Agent a) const {
+    assert(a < agents_);
+    return a * ids_.size();
+  }
+
+  std::size_t cell(std::size_t row, Agent a) const {
+    assert(row < ids_.size());
+    return column(a) + row;
+  }
+
+  GoalId intern(const std::string& goal);
+
+  std::uint64_t version_ = 0;
+  std::size_t agents_ = 0;
+  std::vector<WorldId> ids_;
+
+  std::vector<double> x_;
+  std::vector<double> y_;
+  std::vector<double> theta_;
+  std::vector<GoalId> goals_;
+
+  std::vector<std::string> goal_names_;
+  std::unordered_map<std::string, GoalId> goal_index_;
+};
+
+} // namespace epistemic
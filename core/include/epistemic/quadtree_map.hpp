@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "world.hpp"
+
+namespace epistemic {
+
+/**
+ * Occupancy map as a region quadtree over the smallest power-of-two
+ * square covering the map. Uniform quadrants collapse into a single
+ * leaf, so large Unknown or Free areas cost nothing beyond their
+ * parent's child slot.
+ *
+ * Offers the read interface interpret_atom uses on GridMap (at, count,
+ * region_free); cells outside width x height read as Unknown. A World
+ * can hold its map in this form (World::store_map).
+ */
+class QuadtreeMap {
+public:
+  QuadtreeMap() : QuadtreeMap(0, 0, 0.0) {}
+
+  /** All cells Unknown. */
+  QuadtreeMap(
+    std::uint32_t width,
+    std::uint32_t height,
+    double resolution
+  );
+
+  static QuadtreeMap from_dense(const GridMap& map);
+
+  GridMap to_dense() const;
+
+  std::uint32_t width() const { return width_; }
+  std::uint32_t height() const { return height_; }
+  double resolution() const { return resolution_; }
+
+  /** O(log side); Unknown outside width x height. */
+  CellState at(std::uint32_t x, std::uint32_t y) const;
+
+  /** A uniform square of cells: lower-left cell (x, y), side `size`. */
+  struct Block {
+    std::uint32_t x;
+    std::uint32_t y;
+    std::uint32_t size;
+    CellState state;
+  };
+
+  /**
+   * The largest uniform block holding cell (x, y), in O(log side), so
+   * walkers can step over it without further lookups. Cells outside
+   * width x height form single Unknown blocks.
+   */
+  Block block_at(std::uint32_t x, std::uint32_t y) const;
+
+  /**
+   * Splits leaves on the way down and re-collapses on the way up.
+   * @throws std::out_of_range outside width x height
+   */
+  void set(std::uint32_t x, std::uint32_t y, CellState state);
+
+  /**
+   * Cells in state s within the inclusive rectangle [x0, x1] x [y0, y1],
+   * visiting only the nodes that straddle its border.
+   */
+  std::uint32_t count(
+    std::uint32_t x0,
+    std::uint32_t y0,
+    std::uint32_t x1,
+    std::uint32_t y1,
+    CellState s
+  ) const;
+
+  bool region_free(
+    std::uint32_t x0,
+    std::uint32_t y0,
+    std::uint32_t x1,
+    std::uint32_t y1
+  ) const;
+
+  /** Internal nodes in use; leaves are stored inline. */
+  std::size_t node_count() const { return nodes_.size() - free_.size(); }
+
+  std::size_t memory_bytes() const;
+
+  /**
+   * GridMap::distance_field of the dense form, built on first use and
+   * kept until set(). Copies of a shared tree expand it once between
+   * them, not once per reader.
+   */
+  std::shared_ptr<const DistanceField> distance_field() const;
+
+  /** GridMap::hash of the dense form, kept current by set(); O(1). */
+  std::uint64_t hash() const { return hash_; }
+
+  /** Same size and cells. */
+  bool operator==(const QuadtreeMap& other) const;
+
+private:
+  // A child slot: an internal node index, or kLeaf | state.
+  using Ref = std::uint32_t;
+  static constexpr Ref kLeaf = Ref{1} << 31;
+
+  struct Node {
+    Ref child[4];
+  };
+
+  static bool is_leaf(Ref r) { return (r & kLeaf) != 0; }
+  static Ref leaf(CellState s) { return kLeaf | static_cast<Ref>(s); }
+  static CellState leaf_state(Ref r) { return static_cast<CellState>(r & ~kLeaf); }
+
+  Ref build(const GridMap& map, std::uint32_t x, std::uint32_t y, std::uint32_t size);
+  void fill(GridMap& map, Ref r, std::uint32_t x, std::uint32_t y, std::uint32_t size) const;
+  Ref set(Ref r, std::uint32_t x, std::uint32_t y, std::uint32_t size, CellState s);
+  std::uint32_t count(
+    Ref r,
+    std::uint32_t x,
+    std::uint32_t y,
+    std::uint32_t size,
+    std::uint32_t x0,
+    std::uint32_t y0,
+    std::uint32_t x1,
+    std::uint32_t y1,
+    CellState s
+  ) const;
+  bool equal(Ref a, const QuadtreeMap& other, Ref b) const;
+
+  Ref allocate(const Node& node);
+  void release(Ref r);
+
+  std::uint32_t width_ = 0;
+  std::uint32_t height_ = 0;
+  double resolution_ = 0.0;
+
+  std::uint32_t side_ = 1; // power of two >= width, height
+  Ref root_ = leaf(CellState::Unknown);
+  std::uint64_t hash_ = 0;
+
+  std::vector<Node> nodes_;
+  std::vector<Ref> free_;
+
+  mutable std::shared_ptr<const DistanceField> field_;
+};
+
+} // namespace epistemic
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 #include "belief_state.hpp"
 #include "formula.hpp"
 
@@ -23,4 +25,30 @@ bool holds_in_all(
   const Formula& phi
 );
 
+/**
+ * Structural hash of a formula: formulas that are formula_equal hash
+ * equally. Distinct formulas may collide, so a cache keyed by the hash
+ * must confirm hits with formula_equal.
+ */
+std::size_t formula_hash(
+  const Formula& phi
+);
+
+/**
+ * Structural equality over the alternatives `holds` interprets; other
+ * alternatives compare by identity.
+ */
+bool formula_equal(
+  const Formula& a,
+  const Formula& b
+);
+
+/**
+ * True iff every node of phi is an alternative formula_equal compares
+ * structurally, so an equal formula can reuse results cached for phi.
+ */
+bool formula_cacheable(
+  const Formula& phi
+);
+
 } // namespace epistemic
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "belief_state.hpp"
+#include "formula.hpp"
+
+namespace epistemic {
+
+struct QueryCacheStats {
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+
+  // Number of times the cache was flushed because a new belief
+  // version was queried.
+  std::uint64_t invalidations = 0;
+
+  double hit_rate() const {
+    const std::uint64_t total = hits + misses;
+    return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+  }
+};
+
+/**
+ * Memoizes query results for one belief version at a time.
+ *
+ * Each queried formula is interned: a copy is kept and later queries
+ * are matched to it by formula_hash and confirmed with formula_equal,
+ * so colliding formulas never share results. Formulas that are not
+ * formula_cacheable would never match their copy, so they bypass the
+ * cache and count as misses. Entries are keyed by
+ * (formula id, world) for `holds` and by formula id for `holds_in_all`.
+ * Querying a BeliefState with a different `version` (e.g. the result
+ * of product_update or public_announcement) drops every entry first,
+ * so stale answers are never returned.
+ *
+ * Every call counts exactly one hit or miss.
+ *
+ * Thread-safe; evaluation itself runs outside the lock.
+ */
+class QueryCache {
+public:
+  bool holds(
+    const BeliefState& belief,
+    WorldId w,
+    const Formula& phi
+  );
+
+  bool holds_in_all(
+    const BeliefState& belief,
+    const Formula& phi
+  );
+
+  QueryCacheStats stats() const;
+
+  void clear();
+
+private:
+  struct Key {
+    std::size_t formula;
+    WorldId world;
+
+    bool operator==(const Key& other) const {
+      return formula == other.formula && world == other.world;
+    }
+  };
+
+  struct KeyHash {
+    std::size_t operator()(const Key& k) const {
+      return k.formula ^ (std::hash<WorldId>{}(k.world) * 0x9e3779b97f4a7c15ULL);
+    }
+  };
+
+  // Requires mutex_ held.
+  void sync(const BeliefState& belief);
+
+  // Requires mutex_ held. Id of phi's interned copy, added if new.
+  std::size_t intern(
+    const Formula& phi,
+    std::size_t hash
+  );
+
+  // Per-world lookup shared by both queries; `count` says whether the
+  // lookup is the caller's query or part of holds_in_all.
+  bool holds_world(
+    const BeliefState& belief,
+    WorldId w,
+    const Formula& phi,
+    std::size_t hash,
+    bool count
+  );
+
+  mutable std::mutex mutex_;
+  std::uint64_t version_ = 0;
+
+  // Bumped whenever ids are reset, so a result computed against an
+  // older id is not inserted.
+  std::uint64_t epoch_ = 0;
+
+  std::vector<Formula> formulas_;
+  std::unordered_multimap<std::size_t, std::size_t> by_hash_;
+  std::unordered_map<Key, bool, KeyHash> world_results_;
+  std::unordered_map<std::size_t, bool> all_results_;
+  QueryCacheStats stats_;
+};
+
+} // namespace epistemic
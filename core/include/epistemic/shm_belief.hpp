@@ -0,0 +1,237 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "belief_state.hpp"
+
+namespace epistemic {
+
+namespace shm {
+
+// Position-independent snapshot records. Every offset is in bytes from
+// the start of the slot holding the snapshot, so the same bytes are
+// valid at any mapping address.
+
+struct SnapshotHeader {
+  std::uint64_t version;
+  std::uint64_t bytes_used;
+
+  std::uint64_t world_count;
+  std::uint64_t worlds_offset;       // ShmWorld[world_count]
+
+  std::uint64_t designated_count;
+  std::uint64_t designated_offset;   // WorldId[designated_count]
+
+  std::uint64_t agent_count;
+  std::uint64_t relations_offset;    // ShmRelation[agent_count]
+};
+
+struct ShmWorld {
+  WorldId id;
+  std::uint32_t width;
+  std::uint32_t height;
+  double resolution;
+  std::uint64_t cells_offset;        // CellState[width * height]
+  std::uint64_t pose_count;
+  std::uint64_t poses_offset;        // ShmPose[pose_count]
+  std::uint64_t goal_count;
+  std::uint64_t goals_offset;        // ShmGoal[goal_count]
+};
+
+struct ShmPose {
+  Agent agent;
+  std::uint32_t reserved;
+  double x;
+  double y;
+  double theta;
+};
+
+struct ShmGoal {
+  Agent agent;
+  std::uint32_t length;
+  std::uint64_t text_offset;         // char[length], not terminated
+};
+
+struct ShmEdge {
+  WorldId from;
+  WorldId to;
+};
+
+struct ShmRelation {
+  std::uint64_t edge_count;
+  std::uint64_t edges_offset;        // ShmEdge[edge_count]
+};
+
+/**
+ * Region header. Two slots are written alternately; each is guarded by
+ * its own seqlock counter (odd while being written).
+ */
+struct RegionHeader {
+  std::uint32_t magic;
+  std::uint32_t layout_version;
+  std::uint64_t slot_capacity;
+  std::uint64_t slot_offset[2];
+  std::int64_t owner_pid;                 // publisher process
+
+  std::atomic<std::uint64_t> slot_sequence[2];
+  std::atomic<std::uint32_t> latest;      // slot of the newest snapshot
+  std::atomic<std::uint64_t> publications;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "shared-memory seqlock needs lock-free 64-bit atomics");
+
+} // namespace shm
+
+/**
+ * Zero-copy view of a snapshot inside a mapped region.
+ *
+ * Reads go straight to shared memory. The writer only reuses a slot
+ * after publishing into the other one, so a view stays intact for at
+ * least one publication period; still_valid() tells for sure.
+ *
+ * Every offset and count read from the region is checked against the
+ * slot capacity before use, so a torn or corrupt snapshot throws
+ * std::runtime_error instead of reading outside the slot.
+ */
+class BeliefSnapshotView {
+public:
+  std::uint64_t version() const { return header().version; }
+
+  std::size_t world_count() const { return header().world_count; }
+  const shm::ShmWorld& world(std::size_t i) const;
+
+  const CellState* cells(const shm::ShmWorld& w) const;
+  const shm::ShmPose* poses(const shm::ShmWorld& w) const;
+  const shm::ShmGoal* goals(const shm::ShmWorld& w) const;
+  std::string goal_text(const shm::ShmGoal& g) const;
+
+  std::size_t designated_count() const { return header().designated_count; }
+  const WorldId* designated() const;
+
+  std::size_t agent_count() const { return header().agent_count; }
+  const shm::ShmRelation& relation(Agent a) const;
+  const shm::ShmEdge* edges(const shm::ShmRelation& r) const;
+
+  /**
+   * True while the writer has not started overwriting this slot.
+   */
+  bool still_valid() const;
+
+  /**
+   * Copy the snapshot out into an ordinary BeliefState.
+   */
+  BeliefState to_belief() const;
+
+private:
+  friend class ShmBeliefSubscriber;
+
+  BeliefSnapshotView(
+    const unsigned char* slot,
+    std::uint64_t capacity,
+    const std::atomic<std::uint64_t>* sequence,
+    std::uint64_t expected
+  ) : slot_(slot), capacity_(capacity), sequence_(sequence), expected_(expected) {}
+
+  // `count` records of T at `offset`, all inside the slot.
+  template <typename T>
+  const T* at(
+    std::uint64_t offset,
+    std::uint64_t count = 1
+  ) const;
+
+  const shm::SnapshotHeader& header() const {
+    return *at<shm::SnapshotHeader>(0);
+  }
+
+  const unsigned char* slot_;
+  std::uint64_t capacity_;
+  const std::atomic<std::uint64_t>* sequence_;
+  std::uint64_t expected_;
+};
+
+/**
+ * Writer side: owns a POSIX shared-memory region and publishes
+ * snapshots into it with a double-buffered seqlock handoff.
+ */
+class ShmBeliefPublisher {
+public:
+  /**
+   * Creates the region exclusively. A region left behind by a publisher
+   * that no longer runs is replaced; readers still mapping it keep the
+   * old copy until they reopen.
+   *
+   * @param name POSIX shm name, e.g. "/epistemic_belief"
+   * @param slot_capacity bytes available per snapshot
+   * @throws std::runtime_error if the region cannot be created or
+   *         another live publisher owns it
+   */
+  ShmBeliefPublisher(const std::string& name, std::size_t slot_capacity);
+  ~ShmBeliefPublisher();
+
+  ShmBeliefPublisher(const ShmBeliefPublisher&) = delete;
+  ShmBeliefPublisher& operator=(const ShmBeliefPublisher&) = delete;
+
+  /**
+   * Maps are published as dense cells whatever their MapStorage.
+   * @throws std::runtime_error if the snapshot exceeds slot_capacity
+   */
+  void publish(const BeliefState& belief);
+
+  /**
+   * Bytes a snapshot of `belief` occupies.
+   */
+  static std::size_t snapshot_size(const BeliefState& belief);
+
+  // Remove the shm name when this publisher is destroyed.
+  void set_unlink_on_close(bool unlink) { unlink_ = unlink; }
+
+  std::uint64_t publications() const;
+
+private:
+  std::string name_;
+  void* base_ = nullptr;
+  std::size_t size_ = 0;
+  bool unlink_ = true;
+};
+
+/**
+ * Reader side: maps an existing region read-only.
+ */
+class ShmBeliefSubscriber {
+public:
+  /**
+   * @throws std::runtime_error if the region does not exist or is
+   *         not a belief region
+   */
+  explicit ShmBeliefSubscriber(const std::string& name);
+  ~ShmBeliefSubscriber();
+
+  ShmBeliefSubscriber(const ShmBeliefSubscriber&) = delete;
+  ShmBeliefSubscriber& operator=(const ShmBeliefSubscriber&) = delete;
+
+  /**
+   * Newest complete snapshot, or nullopt if none has been published.
+   */
+  std::optional<BeliefSnapshotView> latest() const;
+
+  std::uint64_t publications() const;
+
+private:
+  const shm::RegionHeader& header() const {
+    return *static_cast<const shm::RegionHeader*>(base_);
+  }
+
+  void* base_ = nullptr;
+  std::size_t size_ = 0;
+
+  // Validated copies of the header's layout fields.
+  std::uint64_t slot_capacity_ = 0;
+  std::uint64_t slot_offset_[2] = {0, 0};
+};
+
+} // namespace epistemic
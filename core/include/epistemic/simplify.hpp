@@ -0,0 +1,64 @@
+#ifndef EPISTEMIC_SIMPLIFY_HPP
+#define EPISTEMIC_SIMPLIFY_HPP
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "formula.hpp"
+#include "kripke_model.hpp"
+
+namespace epistemic {
+
+/**
+ * @brief Options for simplify()
+ */
+struct SimplifyOptions {
+    /// Push negations inward and rewrite φ → ψ as ¬φ ∨ ψ
+    bool negation_normal_form = true;
+
+    /// Relations are equivalence relations (S5), which enables
+    /// K_a K_a φ → K_a φ, K_a ¬K_a φ → ¬K_a φ, K_a ⊥ → ⊥, C_G C_G φ → C_G φ
+    /// and D_G D_G φ → D_G φ. Unsound otherwise, so off by default; see
+    /// simplify_options_for().
+    bool s5 = false;
+};
+
+/**
+ * @brief Options whose modal reductions are sound in a model
+ *
+ * Enables the S5 reductions only if every relation of the model is an
+ * equivalence relation.
+ */
+SimplifyOptions simplify_options_for(const KripkeModel& model);
+
+/**
+ * @brief Rewrite a formula into an equivalent, usually smaller one
+ *
+ * Performs constant folding, flattening and deduplication of ∧/∨ chains
+ * (including φ ∧ ¬φ → ⊥ and φ ∨ ¬φ → ⊤), removal of double negations,
+ * K_a ⊤ → ⊤ and, depending on the options, negation normal form and S5
+ * modal reductions. There is no dual modality, so NNF stops at ¬K_a,
+ * ¬E_G, ¬C_G and ¬D_G.
+ *
+ * @param phi Formula to simplify
+ * @param options Rewrites to enable
+ * @return Simplified copy
+ */
+std::unique_ptr<Formula> simplify(const Formula& phi, const SimplifyOptions& options = {});
+
+/**
+ * @brief Nesting depth of knowledge operators (0 for propositional formulas)
+ *
+ * A query helper; simplify() itself does not use it.
+ */
+int modal_depth(const Formula& phi);
+
+/**
+ * @brief Atomic propositions occurring in a formula
+ */
+std::set<std::string> atoms(const Formula& phi);
+
+} // namespace epistemic
+
+#endif // EPISTEMIC_SIMPLIFY_HPP
@@ -10,6 +10,12 @@ namespace epistemic {
 struct LidarObservation {
   std::vector<double> ranges;
   double max_range;
+
+  // Beam i points at angle_min + i * angle_increment, relative to the
+  // sensor heading. An increment of 0 spreads the beams evenly over a
+  // full turn.
+  double angle_min = 0.0;
+  double angle_increment = 0.0;
 };
 
 struct LidarSensorModel {
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "belief_state.hpp"
+#include "quadtree_map.hpp"
+#include "thread_pool.hpp"
+#include "slam_events/lidar_event.hpp"
+
+namespace epistemic {
+
+/**
+ * Per-beam direction cosines of a scan relative to the sensor heading,
+ * computed once per scan and rotated per pose.
+ */
+struct BeamTable {
+  std::vector<double> cos_rel;
+  std::vector<double> sin_rel;
+
+  explicit BeamTable(const LidarObservation& obs);
+
+  std::size_t size() const { return cos_rel.size(); }
+};
+
+/**
+ * Distance in meters from (x, y) along (dx, dy) (unit vector) to the
+ * first Occupied cell, by DDA traversal with early exit. Unknown cells
+ * are passed through; leaving the map or exceeding max_range returns
+ * max_range. The map origin is cell (0, 0)'s corner.
+ */
+double cast_ray(
+  const GridMap& map,
+  double x,
+  double y,
+  double dx,
+  double dy,
+  double max_range
+);
+
+/** Same result as on the dense form; uniform blocks are crossed without lookups. */
+double cast_ray(
+  const QuadtreeMap& map,
+  double x,
+  double y,
+  double dx,
+  double dy,
+  double max_range
+);
+
+/**
+ * Expected ranges of every beam of `beams` from `pose`, written to
+ * out[0 .. beams.size()).
+ */
+void expected_ranges(
+  const GridMap& map,
+  const Pose& pose,
+  const BeamTable& beams,
+  double max_range,
+  double* out
+);
+
+void expected_ranges(
+  const QuadtreeMap& map,
+  const Pose& pose,
+  const BeamTable& beams,
+  double max_range,
+  double* out
+);
+
+std::vector<double> expected_ranges(
+  const GridMap& map,
+  const Pose& pose,
+  const LidarObservation& obs
+);
+
+enum class ScanMethod {
+  Raycast,         // compare ranges with a DDA cast per beam
+  LikelihoodField  // look beam endpoints up in the map's distance field
+};
+
+/**
+ * Which beams of a scan each world explains.
+ *
+ * Evaluates the scan from the sensing agent's pose in every world of
+ * the belief, in parallel over worlds. With Raycast, beam i is
+ * consistent when the expected range is within `tolerance` sigmas of
+ * the observed one; a missing return is consistent with an expected
+ * max-range reading, or with anything if the sensor drops out.
+ * With LikelihoodField, beam i is consistent when its endpoint lies
+ * within `tolerance` sigmas of an occupied cell, or in unknown or
+ * unmapped space; missing returns are ignored.
+ * Worlds without a pose for the sensor cannot refute a beam.
+ */
+class ScanConsistency {
+public:
+  ScanConsistency(
+    const BeliefState& belief,
+    const LidarObservation& obs,
+    const LidarSensorModel& sensor,
+    ThreadPool& pool,
+    Agent sensing_agent = 0,
+    double tolerance = 3.0,
+    ScanMethod method = ScanMethod::Raycast
+  );
+
+  std::size_t beam_count() const { return beams_; }
+
+  /** False for worlds that were not in the belief. */
+  bool consistent(
+    WorldId world,
+    std::size_t beam
+  ) const;
+
+  /**
+   * Expected range of a beam in a world; max_range if unknown or
+   * when evaluated with the likelihood field.
+   */
+  double expected(
+    WorldId world,
+    std::size_t beam
+  ) const;
+
+private:
+  std::size_t beams_;
+  double max_range_;
+
+  std::unordered_map<WorldId, std::size_t> rows_;
+  std::vector<double> expected_;      // rows_ x beams_
+  std::vector<std::uint8_t> agrees_;  // rows_ x beams_
+};
+
+/**
+ * Makes a ScanConsistency the one interpret_atom consults for
+ * `lidar_bin_i` atoms while in scope, on the constructing thread only
+ * (queries spread over a pool do not see it). Scopes nest and must be
+ * destroyed in reverse order, as automatic variables are.
+ */
+class ActiveScan {
+public:
+  explicit ActiveScan(const ScanConsistency& scan);
+  ~ActiveScan();
+
+  ActiveScan(const ActiveScan&) = delete;
+  ActiveScan& operator=(const ActiveScan&) = delete;
+
+  static const ScanConsistency* current();
+
+private:
+  const ScanConsistency* previous_;
+};
+
+/**
+ * Product update with the lidar event of a scan, with its
+ * preconditions evaluated against every world's map.
+ */
+BeliefState lidar_update(
+  const BeliefState& belief,
+  const LidarObservation& obs,
+  const LidarSensorModel& sensor,
+  ThreadPool& pool,
+  ScanMethod method = ScanMethod::Raycast
+);
+
+} // namespace epistemic
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "slam_events/lidar_event.hpp"
+
+namespace epistemic {
+
+/**
+ * One recorded scan.
+ */
+struct ScanFrame {
+  std::uint64_t stamp_ns = 0;
+  LidarObservation obs;
+};
+
+/**
+ * Binary scan log.
+ *
+ * Header: "ESCL", format version (u8), range quantum in meters (f64).
+ * Then one record per frame: payload size (LEB128) and payload:
+ *  - flags (u8); bit 0: scan geometry follows
+ *  - timestamp delta to the previous frame in ns (zigzag LEB128)
+ *  - if geometry: max_range, angle_min, angle_increment (f64),
+ *    beam count (LEB128)
+ *  - per beam, zigzag LEB128 delta of the quantized range to the
+ *    previous beam's. Quantized 0 is a missing return (<= 0, >=
+ *    max_range or not finite), otherwise round(r / quantum) + 1.
+ *
+ * Geometry is written only when it changes, so a steady scanner costs
+ * one to two bytes per beam. Decoded ranges are within quantum / 2 of
+ * the recorded ones; missing returns decode as max_range. Doubles are
+ * IEEE-754 little-endian.
+ */
+class ScanLogWriter {
+public:
+  static constexpr std::uint8_t kVersion = 1;
+
+  /** Writes the header immediately. */
+  explicit ScanLogWriter(
+    std::ostream& out,
+    double quantum = 0.001
+  );
+
+  void write(const ScanFrame& frame);
+
+  std::size_t frames() const { return frames_; }
+  std::size_t bytes() const { return bytes_; }
+
+private:
+  std::ostream& out_;
+  double quantum_;
+
+  std::size_t frames_ = 0;
+  std::size_t bytes_ = 0;
+
+  std::uint64_t last_stamp_ = 0;
+  bool have_geometry_ = false;
+  double max_range_ = 0.0;
+  double angle_min_ = 0.0;
+  double angle_increment_ = 0.0;
+  std::size_t beams_ = 0;
+
+  std::vector<std::uint8_t> payload_;
+};
+
+/**
+ * Sequential reader for ScanLogWriter output.
+ *
+ * @throws std::runtime_error on a bad header or a malformed frame. A
+ * frame cut short by end of file (capture killed mid-write) ends the
+ * log instead.
+ */
+class ScanLogReader {
+public:
+  explicit ScanLogReader(std::istream& in);
+
+  /** False at end of log. */
+  bool next(ScanFrame& frame);
+
+  double quantum() const { return quantum_; }
+
+private:
+  std::istream& in_;
+  double quantum_ = 0.0;
+
+  std::uint64_t last_stamp_ = 0;
+  bool have_geometry_ = false;
+  double max_range_ = 0.0;
+  double angle_min_ = 0.0;
+  double angle_increment_ = 0.0;
+  std::size_t beams_ = 0;
+
+  std::vector<std::uint8_t> payload_;
+};
+
+} // namespace epistemic
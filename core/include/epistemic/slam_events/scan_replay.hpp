@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "belief_state.hpp"
+#include "slam_events/raycast.hpp"
+#include "slam_events/scan_log.hpp"
+
+namespace epistemic {
+
+struct ReplayOptions {
+  LidarSensorModel sensor{0.05, 0.0};
+
+  // 0 replays as fast as possible; 1 at the recorded rate, 2 twice as
+  // fast, and so on. Pacing never drops frames: a slow update just
+  // delays the next one.
+  double rate = 0.0;
+
+  // Stop after this many frames; 0 = whole log
+  std::size_t max_frames = 0;
+
+  // Frames go through lidar_update, which checks each world's map
+  // against the scan. Null runs the checks on a pool owned by the replay.
+  ThreadPool* pool = nullptr;
+  ScanMethod method = ScanMethod::Raycast;
+};
+
+/**
+ * Per-frame update latency in seconds (map checks, event construction,
+ * product update and renumbering; reading and pacing excluded).
+ */
+struct ReplayReport {
+  std::size_t frames = 0;
+  double wall_seconds = 0.0;
+
+  double mean = 0.0;
+  double p50 = 0.0;
+  double p90 = 0.0;
+  double p99 = 0.0;
+  double max = 0.0;
+
+  std::size_t final_worlds = 0;
+
+  double frames_per_second() const {
+    return wall_seconds > 0.0 ? frames / wall_seconds : 0.0;
+  }
+};
+
+/**
+ * Feed every frame of a log through the belief update, in order.
+ *
+ * After each update the worlds are renumbered 0 .. n-1 in model order,
+ * so product ids stay unique however many frames are replayed.
+ * Deterministic given the log and the initial belief: the only source
+ * of variation between runs is timing. `on_frame` sees each updated
+ * belief, outside the measured latency.
+ */
+ReplayReport replay_scan_log(
+  ScanLogReader& reader,
+  BeliefState belief,
+  const ReplayOptions& options = {},
+  const std::function<void(const ScanFrame&, const BeliefState&)>& on_frame = {}
+);
+
+} // namespace epistemic
@@ -0,0 +1,518 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "atom_interpretation.hpp"
+#include "belief_state.hpp"
+#include "event_model.hpp"
+#include "formula.hpp"
+
+namespace epistemic {
+
+namespace static_detail {
+
+template <typename F, std::size_t... I>
+void unroll(F& f, std::index_sequence<I...>) {
+  (f(std::integral_constant<Agent, static_cast<Agent>(I)>{}), ...);
+}
+
+} // namespace static_detail
+
+/**
+ * Call f(std::integral_constant<Agent, a>{}) for a = 0 .. N-1, expanded
+ * at compile time.
+ */
+template <std::size_t N, typename F>
+void unroll_agents(F&& f) {
+  static_detail::unroll(f, std::make_index_sequence<N>{});
+}
+
+/**
+ * Successor lists over dense indices in CSR form: the successors of i
+ * are targets[offsets[i] .. offsets[i + 1]).
+ */
+struct StaticRelation {
+  std::vector<std::uint32_t> offsets{0};
+  std::vector<std::uint32_t> targets;
+
+  const std::uint32_t* begin(std::size_t i) const {
+    return targets.data() + offsets[i];
+  }
+
+  const std::uint32_t* end(std::size_t i) const {
+    return targets.data() + offsets[i + 1];
+  }
+
+  /** Counting sort of edges over [0, n); keeps each source's edge order. */
+  static StaticRelation build(
+    std::size_t n,
+    const std::vector<std::pair<std::uint32_t, std::uint32_t>>& edges
+  ) {
+    StaticRelation r;
+    r.offsets.assign(n + 1, 0);
+    for (const auto& e : edges) ++r.offsets[e.first + 1];
+    for (std::size_t i = 0; i < n; ++i) r.offsets[i + 1] += r.offsets[i];
+
+    r.targets.resize(edges.size());
+    std::vector<std::uint32_t> next(r.offsets.begin(), r.offsets.end() - 1);
+    for (const auto& e : edges) r.targets[next[e.first]++] = e.second;
+    return r;
+  }
+};
+
+/**
+ * Kripke model for exactly N agents, fixed at compile time.
+ *
+ * Worlds are addressed by position and every world is designated, so a
+ * relation lookup is two array reads and no agent or id map is ever
+ * consulted. Build one with to_static<N>() from a BeliefState.
+ */
+template <std::size_t N>
+struct StaticKripkeModel {
+  static_assert(N >= 1 && N <= kMaxGroupAgents, "1..64 agents");
+
+  static constexpr AgentMask kAllAgents =
+    N == kMaxGroupAgents ? ~AgentMask{0} : agent_bit(N) - 1;
+
+  std::vector<World> worlds;
+  std::array<StaticRelation, N> relations;
+};
+
+template <std::size_t N>
+struct StaticBeliefState {
+  StaticKripkeModel<N> model;
+
+  // Copied from and back to BeliefState::version by the conversions
+  std::uint64_t version = next_belief_version();
+
+  std::size_t size() const { return model.worlds.size(); }
+  bool empty() const { return model.worlds.empty(); }
+};
+
+/**
+ * Event model for exactly N agents; events are addressed by position.
+ */
+template <std::size_t N>
+struct StaticEventModel {
+  static_assert(N >= 1 && N <= kMaxGroupAgents, "1..64 agents");
+
+  std::vector<Event> events;
+  std::array<StaticRelation, N> relations;
+};
+
+// Truth value per world index
+using StaticExtension = std::vector<std::uint8_t>;
+
+namespace static_detail {
+
+/** out[i] &= (A knows sub at i) */
+template <Agent A, std::size_t N>
+void knows_into(
+  const StaticKripkeModel<N>& model,
+  const StaticExtension& sub,
+  StaticExtension& out
+) {
+  const StaticRelation& r = std::get<A>(model.relations);
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    if (!out[i]) continue;
+    for (const std::uint32_t* j = r.begin(i); j != r.end(i); ++j) {
+      if (!sub[*j]) {
+        out[i] = 0;
+        break;
+      }
+    }
+  }
+}
+
+template <std::size_t N>
+StaticExtension everybody_knows(
+  const StaticKripkeModel<N>& model,
+  AgentMask group,
+  const StaticExtension& sub
+) {
+  StaticExtension out(model.worlds.size(), 1);
+  unroll_agents<N>([&](auto A) {
+    if (group & agent_bit(decltype(A)::value)) {
+      knows_into<decltype(A)::value>(model, sub, out);
+    }
+  });
+  return out;
+}
+
+template <std::size_t N>
+StaticExtension distributed_knows(
+  const StaticKripkeModel<N>& model,
+  AgentMask group,
+  const StaticExtension& sub
+) {
+  const std::size_t W = model.worlds.size();
+  const AgentMask members = group & StaticKripkeModel<N>::kAllAgents;
+  StaticExtension out(W, 1);
+
+  // An agent beyond N has no edges, so the intersection is empty.
+  if (group != members) return out;
+
+  // The empty group pools nothing: every world is possible.
+  if (members == 0) {
+    for (std::uint8_t v : sub) {
+      if (!v) return StaticExtension(W, 0);
+    }
+    return out;
+  }
+
+  std::size_t needed = 0;
+  for (AgentMask m = members; m != 0; m &= m - 1) ++needed;
+
+  // Per target: how many group members reach it from i
+  std::vector<std::uint32_t> count(W, 0);
+  std::vector<std::uint64_t> mark(W, 0);
+  std::vector<std::uint32_t> touched;
+  std::uint64_t stamp = 0;
+
+  for (std::size_t i = 0; i < W; ++i) {
+    touched.clear();
+
+    unroll_agents<N>([&](auto A) {
+      if (!(members & agent_bit(decltype(A)::value))) return;
+      const StaticRelation& r = std::get<decltype(A)::value>(model.relations);
+
+      ++stamp; // duplicate edges count once per agent
+      for (const std::uint32_t* j = r.begin(i); j != r.end(i); ++j) {
+        if (mark[*j] == stamp) continue;
+        mark[*j] = stamp;
+        if (count[*j]++ == 0) touched.push_back(*j);
+      }
+    });
+
+    for (std::uint32_t j : touched) {
+      if (count[j] == needed && !sub[j]) out[i] = 0;
+      count[j] = 0;
+    }
+  }
+  return out;
+}
+
+} // namespace static_detail
+
+/**
+ * E_G over a compile-time group: the agent loop is unrolled and
+ * agents outside G are compiled out.
+ */
+template <AgentMask G, std::size_t N>
+StaticExtension everybody_knows(
+  const StaticKripkeModel<N>& model,
+  const StaticExtension& sub
+) {
+  static_assert((G & ~StaticKripkeModel<N>::kAllAgents) == 0,
+                "group names an agent beyond N");
+
+  StaticExtension out(model.worlds.size(), 1);
+  unroll_agents<N>([&](auto A) {
+    if constexpr ((G & agent_bit(decltype(A)::value)) != 0) {
+      static_detail::knows_into<decltype(A)::value>(model, sub, out);
+    }
+  });
+  return out;
+}
+
+/**
+ * Worlds of the belief where phi holds, indexed like model.worlds.
+ *
+ * Each subformula is evaluated once for all worlds. Unlike holds(),
+ * EverybodyKnows and CommonKnowledge (reflexive-transitive, as in
+ * SymbolicModel) are supported; unsupported alternatives are false.
+ */
+template <std::size_t N>
+StaticExtension extension(
+  const StaticBeliefState<N>& belief,
+  const Formula& phi
+) {
+  const auto& model = belief.model;
+  const std::size_t W = model.worlds.size();
+
+  return std::visit([&](auto&& arg) -> StaticExtension {
+
+    using T = std::decay_t<decltype(arg)>;
+
+    if constexpr (std::is_same_v<T, Atom>) {
+      StaticExtension out(W);
+      for (std::size_t i = 0; i < W; ++i) {
+        out[i] = interpret_atom(model.worlds[i], arg);
+      }
+      return out;
+    }
+
+    else if constexpr (std::is_same_v<T, Not>) {
+      StaticExtension out = extension(belief, *arg.phi);
+      for (auto& v : out) v = !v;
+      return out;
+    }
+
+    else if constexpr (std::is_same_v<T, And>) {
+      StaticExtension out = extension(belief, *arg.left);
+      const StaticExtension right = extension(belief, *arg.right);
+      for (std::size_t i = 0; i < W; ++i) out[i] = out[i] && right[i];
+      return out;
+    }
+
+    // Agents beyond N have no edges, so they know everything.
+    else if constexpr (std::is_same_v<T, Knows>) {
+      const StaticExtension sub = extension(belief, *arg.phi);
+      StaticExtension out(W, 1);
+      unroll_agents<N>([&](auto A) {
+        if (arg.agent == decltype(A)::value) {
+          static_detail::knows_into<decltype(A)::value>(model, sub, out);
+        }
+      });
+      return out;
+    }
+
+    else if constexpr (std::is_same_v<T, EverybodyKnows>) {
+      return static_detail::everybody_knows(
+        model, arg.group, extension(belief, *arg.phi));
+    }
+
+    // C_G φ = φ ∧ νZ. E_G(φ ∧ Z)
+    else if constexpr (std::is_same_v<T, CommonKnowledge>) {
+      const StaticExtension sub = extension(belief, *arg.phi);
+
+      StaticExtension z(W, 1);
+      for (;;) {
+        StaticExtension target(W);
+        for (std::size_t i = 0; i < W; ++i) target[i] = sub[i] && z[i];
+
+        StaticExtension next_z = static_detail::everybody_knows(model, arg.group, target);
+        if (next_z == z) break;
+        z = std::move(next_z);
+      }
+
+      for (std::size_t i = 0; i < W; ++i) z[i] = z[i] && sub[i];
+      return z;
+    }
+
+    else if constexpr (std::is_same_v<T, DistributedKnowledge>) {
+      return static_detail::distributed_knows(
+        model, arg.group, extension(belief, *arg.phi));
+    }
+
+    else {
+      return StaticExtension(W, 0);
+    }
+
+  }, phi.value);
+}
+
+template <std::size_t N>
+bool holds_in_all(
+  const StaticBeliefState<N>& belief,
+  const Formula& phi
+) {
+  for (std::uint8_t v : extension(belief, phi)) {
+    if (!v) return false;
+  }
+  return true;
+}
+
+/**
+ * Product update with a static event model; same worlds, ids, order
+ * and edges as product_update on the dynamic forms. Preconditions are
+ * evaluated once per event over all worlds.
+ */
+template <std::size_t N>
+StaticBeliefState<N> product_update(
+  const StaticBeliefState<N>& belief,
+  const StaticEventModel<N>& event_model
+) {
+  constexpr std::uint32_t kNone = ~std::uint32_t{0};
+
+  const auto& worlds = belief.model.worlds;
+  const auto& events = event_model.events;
+  const std::size_t W = worlds.size();
+  const std::size_t E = events.size();
+
+  std::vector<StaticExtension> pre;
+  pre.reserve(E);
+  for (const Event& e : events) pre.push_back(extension(belief, e.precondition));
+
+  // (w, e) -> index of the product world, or kNone
+  StaticBeliefState<N> updated;
+  std::vector<std::uint32_t> index(W * E, kNone);
+
+  for (std::size_t w = 0; w < W; ++w) {
+    for (std::size_t e = 0; e < E; ++e) {
+      if (!pre[e][w]) continue;
+
+      index[w * E + e] = static_cast<std::uint32_t>(updated.model.worlds.size());
+      World world = worlds[w];
+      world.id = (static_cast<WorldId>(worlds[w].id) << 32) |
+                 static_cast<WorldId>(events[e].id);
+      updated.model.worlds.push_back(std::move(world));
+    }
+  }
+
+  unroll_agents<N>([&](auto A) {
+    constexpr Agent a = decltype(A)::value;
+    const StaticRelation& rw = std::get<a>(belief.model.relations);
+    const StaticRelation& re = std::get<a>(event_model.relations);
+    StaticRelation& out = std::get<a>(updated.model.relations);
+
+    // Product worlds were numbered in (w, e) order, so appending
+    // successor runs in that order yields the CSR directly.
+    out.offsets.reserve(updated.model.worlds.size() + 1);
+    for (std::size_t w1 = 0; w1 < W; ++w1) {
+      for (std::size_t e1 = 0; e1 < E; ++e1) {
+        if (index[w1 * E + e1] == kNone) continue;
+
+        for (const std::uint32_t* w2 = rw.begin(w1); w2 != rw.end(w1); ++w2) {
+          for (const std::uint32_t* e2 = re.begin(e1); e2 != re.end(e1); ++e2) {
+            const std::uint32_t target = index[*w2 * E + *e2];
+            if (target != kNone) out.targets.push_back(target);
+          }
+        }
+        out.offsets.push_back(static_cast<std::uint32_t>(out.targets.size()));
+      }
+    }
+  });
+
+  return updated;
+}
+
+/**
+ * Static form of a belief: its designated worlds, in designated order,
+ * and the edges among them (holds only ever quantifies over those).
+ * Designated ids without a world are dropped.
+ *
+ * @throws std::invalid_argument if an agent >= N has edges
+ */
+template <std::size_t N>
+StaticBeliefState<N> to_static(const BeliefState& belief) {
+  StaticBeliefState<N> out;
+  out.version = belief.version;
+
+  std::unordered_map<WorldId, const World*> by_id;
+  for (const World& w : belief.model.worlds) by_id.emplace(w.id, &w);
+
+  std::unordered_map<WorldId, std::uint32_t> index;
+  for (WorldId id : belief.designated) {
+    auto it = by_id.find(id);
+    if (it == by_id.end()) continue;
+    if (!index.emplace(id, static_cast<std::uint32_t>(out.model.worlds.size())).second) continue;
+    out.model.worlds.push_back(*it->second);
+  }
+
+  const auto& accessibility = belief.model.accessibility;
+  for (std::size_t a = N; a < accessibility.size(); ++a) {
+    if (!accessibility[a].empty()) {
+      throw std::invalid_argument("to_static: relation for an agent beyond N");
+    }
+  }
+
+  unroll_agents<N>([&](auto A) {
+    constexpr Agent a = decltype(A)::value;
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    if (a < accessibility.size()) {
+      for (const auto& [w1, w2] : accessibility[a]) {
+        auto i1 = index.find(w1);
+        auto i2 = index.find(w2);
+        if (i1 == index.end() || i2 == index.end()) continue;
+        edges.push_back({i1->second, i2->second});
+      }
+    }
+    std::get<a>(out.model.relations) = StaticRelation::build(out.model.worlds.size(), edges);
+  });
+
+  return out;
+}
+
+template <std::size_t N>
+BeliefState to_dynamic(const StaticBeliefState<N>& belief) {
+  BeliefState out;
+  out.version = belief.version;
+
+  const auto& worlds = belief.model.worlds;
+  out.model.worlds = worlds;
+  out.designated.reserve(worlds.size());
+  for (const World& w : worlds) out.designated.push_back(w.id);
+
+  out.model.accessibility.resize(N);
+  unroll_agents<N>([&](auto A) {
+    constexpr Agent a = decltype(A)::value;
+    const StaticRelation& r = std::get<a>(belief.model.relations);
+    auto& edges = out.model.accessibility[a];
+
+    edges.reserve(r.targets.size());
+    for (std::size_t i = 0; i < worlds.size(); ++i) {
+      for (const std::uint32_t* j = r.begin(i); j != r.end(i); ++j) {
+        edges.push_back({worlds[i].id, worlds[*j].id});
+      }
+    }
+  });
+
+  return out;
+}
+
+/**
+ * @throws std::invalid_argument if an agent >= N has edges
+ */
+template <std::size_t N>
+StaticEventModel<N> to_static(const EventModel& event_model) {
+  StaticEventModel<N> out;
+  out.events = event_model.events;
+
+  std::unordered_map<std::size_t, std::uint32_t> index;
+  for (std::size_t i = 0; i < out.events.size(); ++i) {
+    index.emplace(out.events[i].id, static_cast<std::uint32_t>(i));
+  }
+
+  const auto& accessibility = event_model.accessibility;
+  for (std::size_t a = N; a < accessibility.size(); ++a) {
+    if (!accessibility[a].empty()) {
+      throw std::invalid_argument("to_static: relation for an agent beyond N");
+    }
+  }
+
+  unroll_agents<N>([&](auto A) {
+    constexpr Agent a = decltype(A)::value;
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    for (const auto& [e1, e2] : event_model.relation(a)) {
+      auto i1 = index.find(e1);
+      auto i2 = index.find(e2);
+      if (i1 == index.end() || i2 == index.end()) continue;
+      edges.push_back({i1->second, i2->second});
+    }
+    std::get<a>(out.relations) = StaticRelation::build(out.events.size(), edges);
+  });
+
+  return out;
+}
+
+template <std::size_t N>
+EventModel to_dynamic(const StaticEventModel<N>& event_model) {
+  EventModel out;
+  out.events = event_model.events;
+
+  unroll_agents<N>([&](auto A) {
+    constexpr Agent a = decltype(A)::value;
+    const StaticRelation& r = std::get<a>(event_model.relations);
+
+    for (std::size_t i = 0; i < out.events.size(); ++i) {
+      for (const std::uint32_t* j = r.begin(i); j != r.end(i); ++j) {
+        out.add_edge(a, out.events[i].id, out.events[*j].id);
+      }
+    }
+  });
+
+  return out;
+}
+
+} // namespace epistemic
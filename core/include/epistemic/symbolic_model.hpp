@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "agent.hpp"
+#include "bdd.hpp"
+#include "formula.hpp"
+
+namespace epistemic {
+
+/**
+ * Symbolic Kripke model over n boolean state variables.
+ *
+ * A world is an assignment to x_0..x_{n-1}. Sets of worlds are BDDs
+ * over x; the accessibility relation of each agent is a BDD over
+ * (x, x'). Variables are interleaved (x_i = 2i, x'_i = 2i+1) so
+ * relations that relate x_i to x'_i stay small.
+ *
+ * Formulas are evaluated to their extension (set of worlds), so a
+ * model with 2^40 worlds costs only as much as its BDDs.
+ */
+class SymbolicModel {
+public:
+  explicit SymbolicModel(std::size_t state_vars);
+
+  BddManager& manager() { return bdd_; }
+
+  std::size_t state_vars() const { return n_; }
+
+  // BDD of x_i, resp. x'_i
+  BddRef current(std::size_t i);
+  BddRef next(std::size_t i);
+
+  /**
+   * Single world from a full assignment to x.
+   */
+  BddRef world(const std::vector<bool>& assignment);
+
+  /**
+   * Restrict the model to a set of worlds (over x). Defaults to all.
+   */
+  void set_domain(BddRef worlds) { domain_ = worlds; }
+  BddRef domain() const { return domain_; }
+
+  /**
+   * Valuation: atom `name` holds exactly in `worlds` (over x).
+   * Atoms that are never defined are false everywhere.
+   */
+  void define_atom(const std::string& name, BddRef worlds);
+
+  // Convenience: atom `name` is the state variable x_i.
+  void bind_atom(const std::string& name, std::size_t i);
+
+  /**
+   * Accessibility of agent a, as a BDD over (x, x').
+   */
+  void set_relation(Agent a, BddRef relation);
+
+  /**
+   * Convenience: agent a cannot tell apart worlds that differ only
+   * in variables outside `observed` (an S5 observation relation).
+   */
+  void set_observation_relation(
+    Agent a,
+    const std::vector<std::size_t>& observed
+  );
+
+  /**
+   * Extension of phi: the set of domain worlds where phi holds.
+   */
+  BddRef extension(const Formula& phi);
+
+  bool holds(const std::vector<bool>& assignment, const Formula& phi);
+
+  /**
+   * True iff phi holds in every world of `designated` (over x).
+   */
+  bool holds_in_all(BddRef designated, const Formula& phi);
+
+  /**
+   * Restrict the domain to the extension of phi. Relations need no
+   * rewrite, since every operator intersects with the domain.
+   */
+  void public_announcement(const Formula& phi);
+
+  long double world_count();
+
+private:
+  BddRef knows(Agent a, BddRef phi_ext);
+
+  // Knowledge under the intersection of the group's relations
+  BddRef distributed(AgentMask group, BddRef phi_ext);
+
+  // pre_a(S) = { w | ∃w'. R_a(w, w') ∧ w' ∈ S }
+  BddRef preimage(Agent a, BddRef set);
+
+  std::size_t n_;
+  BddManager bdd_;
+
+  BddRef domain_ = kBddTrue;
+  BddRef next_cube_ = kBddTrue;
+
+  // x_i -> x'_i
+  std::vector<BddVar> to_next_;
+
+  std::unordered_map<std::string, BddRef> atoms_;
+  // Indexed by agent; missing agents have no edges.
+  std::vector<BddRef> relations_;
+};
+
+} // namespace epistemic
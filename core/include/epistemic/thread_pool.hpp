@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace epistemic {
+
+/**
+ * Fixed-size work-stealing pool shared by the parallel query, update
+ * and planning paths.
+ *
+ * Each worker owns a deque. Tasks submitted from a worker go to its
+ * own deque and are popped LIFO (cache-warm, depth-first); idle
+ * workers steal FIFO from the others. External submissions are spread
+ * round-robin.
+ */
+class ThreadPool {
+public:
+  explicit ThreadPool(
+    std::size_t threads = std::thread::hardware_concurrency()
+  );
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  std::size_t size() const { return workers_.size(); }
+
+  void submit(std::function<void()> task);
+
+  /**
+   * Block until every submitted task has finished.
+   */
+  void wait();
+
+  /**
+   * Run body(i) for i in [0, n), in chunks of `grain` indices.
+   * The caller participates, so nested calls from worker threads
+   * cannot deadlock. The first exception thrown by body is rethrown.
+   */
+  template <typename F>
+  void parallel_for(std::size_t n, F&& body, std::size_t grain = 1);
+
+private:
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  void worker_loop(std::size_t index);
+
+  bool try_pop(std::size_t index, std::function<void()>& task);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> workers_;
+
+  // Tasks sitting in some deque, resp. submitted but not yet finished.
+  std::atomic<std::size_t> queued_{0};
+  std::atomic<std::size_t> pending_{0};
+  std::atomic<std::size_t> next_queue_{0};
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable idle_cv_;
+  bool stopping_ = false;
+};
+
+template <typename F>
+void ThreadPool::parallel_for(std::size_t n, F&& body, std::size_t grain) {
+  if (n == 0) return;
+  if (grain == 0) grain = 1;
+
+  const std::size_t chunks = (n + grain - 1) / grain;
+
+  struct State {
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> done{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::exception_ptr error;
+  };
+  auto state = std::make_shared<State>();
+
+  // Helpers that start after all chunks are claimed return without
+  // touching `body`, so it may safely live on the caller's stack.
+  auto run = [state, chunks, n, grain, fn = &body]() {
+    for (;;) {
+      const std::size_t c = state->next.fetch_add(1);
+      if (c >= chunks) return;
+
+      try {
+        const std::size_t end = std::min(n, (c + 1) * grain);
+        for (std::size_t i = c * grain; i < end; ++i) {
+          (*fn)(i);
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->error) state->error = std::current_exception();
+      }
+
+      if (state->done.fetch_add(1) + 1 == chunks) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->cv.notify_all();
+      }
+    }
+  };
+
+  const std::size_t helpers = std::min(size(), chunks - 1);
+  for (std::size_t i = 0; i < helpers; ++i) {
+    submit(run);
+  }
+  run();
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->cv.wait(lock, [&] { return state->done.load() == chunks; });
+  if (state->error) std::rethrow_exception(state->error);
+}
+
+} // namespace epistemic
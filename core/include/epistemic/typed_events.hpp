@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "belief_state.hpp"
+#include "event_model.hpp"
+
+namespace epistemic {
+
+// Common event model shapes. Each converts to a plain EventModel and
+// has an update() overload that avoids the general |R|·|E|² pairing and
+// repeated precondition checks of product_update on that model. The
+// results differ from product_update in two ways:
+//  - edges to worlds that were not designated are dropped rather than
+//    left dangling;
+//  - update(PublicAnnouncementEvent) is public_announcement: surviving
+//    worlds keep their ids instead of becoming (w << 32) | 0.
+// Otherwise worlds, ids and edges are product_update's.
+
+/** Everyone observes that phi holds. */
+struct PublicAnnouncementEvent {
+  Formula phi;
+};
+
+/**
+ * Agents in `learners` observe phi (event 0); everyone else believes
+ * nothing happened (event 1, precondition "true").
+ */
+struct PrivateAnnouncementEvent {
+  AgentMask learners;
+  Formula phi;
+};
+
+/**
+ * Agents in `learners` observe whether phi holds; everyone else knows
+ * they did, but not the answer. Events: 0 = phi, 1 = ¬phi.
+ */
+struct SemiPrivateAnnouncementEvent {
+  AgentMask learners;
+  Formula phi;
+};
+
+/**
+ * Events whose accessibility is a partition per agent, as for sensor
+ * readings: agent a cannot tell events e1, e2 apart iff
+ * classes[a][e1] == classes[a][e2]. An agent without a class vector
+ * has no edges at all.
+ */
+struct PartitionEvent {
+  std::vector<Formula> preconditions;
+  std::vector<std::vector<std::size_t>> classes;
+};
+
+/**
+ * Partition event where the agents in `observers` tell every event
+ * apart and the other agents (up to agent_count) tell none apart.
+ */
+PartitionEvent make_partition_event(
+  std::vector<Formula> preconditions,
+  AgentMask observers,
+  std::size_t agent_count
+);
+
+EventModel to_event_model(const PublicAnnouncementEvent& event, std::size_t agent_count);
+EventModel to_event_model(const PrivateAnnouncementEvent& event, std::size_t agent_count);
+EventModel to_event_model(const SemiPrivateAnnouncementEvent& event, std::size_t agent_count);
+EventModel to_event_model(const PartitionEvent& event);
+
+BeliefState update(const BeliefState& B, const PublicAnnouncementEvent& event);
+BeliefState update(const BeliefState& B, const PrivateAnnouncementEvent& event);
+BeliefState update(const BeliefState& B, const SemiPrivateAnnouncementEvent& event);
+BeliefState update(const BeliefState& B, const PartitionEvent& event);
+
+enum class EventShape {
+  General,
+  Private,    // two events as in PrivateAnnouncementEvent
+  Partition   // includes public and semi-private announcements
+};
+
+/**
+ * Recognize the shape of an event model as seen by agents
+ * [0, agent_count).
+ */
+EventShape detect_shape(
+  const EventModel& E,
+  std::size_t agent_count
+);
+
+/**
+ * Product update that takes the matching fast path when E has a
+ * recognized shape, and falls back to product_update otherwise.
+ */
+BeliefState update(
+  const BeliefState& B,
+  const EventModel& E
+);
+
+} // namespace epistemic
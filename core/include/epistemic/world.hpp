@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <unordered_map>
 #include <string>
 #include <vector>
@@ -11,6 +13,8 @@ namespace epistemic {
 
 using WorldId = std::uint64_t;
 
+class QuadtreeMap;
+
 /**
  * Simple 2D pose for agents.
  * You can generalize later (SE(3), covariance, etc.).
@@ -19,6 +23,10 @@ struct Pose {
   double x;
   double y;
   double theta;
+
+  bool operator==(const Pose& other) const {
+    return x == other.x && y == other.y && theta == other.theta;
+  }
 };
 
 /**
@@ -30,20 +38,204 @@ enum class CellState : std::uint8_t {
   Occupied
 };
 
+/**
+ * Summed-area tables over a grid map: entry (x, y) of each table counts
+ * the matching cells in [0, x) x [0, y). Occupied is the remainder.
+ */
+struct OccupancySums {
+  std::uint64_t revision;
+  std::uint32_t width;
+  std::uint32_t height;
+
+  std::vector<std::uint32_t> free;     // (width + 1) * (height + 1)
+  std::vector<std::uint32_t> unknown;
+};
+
+/**
+ * Euclidean distance transform of a map's occupied cells, used as a
+ * lidar likelihood field. Immutable once built and shared between maps
+ * with identical occupancy.
+ */
+struct DistanceField {
+  std::uint32_t width;
+  std::uint32_t height;
+  double resolution;
+
+  // Meters from each cell to the nearest occupied cell (infinity if
+  // there is none), and that cell's index, or -1.
+  std::vector<float> distance;
+  std::vector<std::int32_t> nearest;
+
+  float at(std::uint32_t x, std::uint32_t y) const {
+    return distance[y * width + x];
+  }
+};
+
 /**
  * Discrete grid map representation.
  * This is intentionally minimal and epistemic-friendly.
+ *
+ * Cells are written only through reset(), assign(), fill() and set(),
+ * which bump the revision the derived tables are keyed on and keep the
+ * Zobrist hash current. Set the shape with reset() or assign(); width
+ * and height must match the cell count.
  */
 struct GridMap {
-  std::uint32_t width;
-  std::uint32_t height;
-  double resolution; // meters per cell
+  std::uint32_t width = 0;
+  std::uint32_t height = 0;
+  double resolution = 0.0; // meters per cell
 
-  std::vector<CellState> cells;
+  // Cells edited by set() since revision edit_base(), so the distance
+  // field can be patched instead of rebuilt. Invariant:
+  // revision() == edit_base() + edits().size().
+  static constexpr std::size_t kEditLog = 256;
 
   CellState at(std::uint32_t x, std::uint32_t y) const {
-    return cells[y * width + x];
+    return cells_[y * width + x];
+  }
+
+  /** Row-major, width * height cells. */
+  const std::vector<CellState>& cells() const { return cells_; }
+
+  std::uint64_t revision() const { return revision_; }
+  std::uint64_t edit_base() const { return edit_base_; }
+  const std::vector<std::uint32_t>& edits() const { return edits_; }
+
+  void set(std::uint32_t x, std::uint32_t y, CellState state) {
+    const std::size_t i = y * width + x;
+
+    zobrist_ ^= cell_key(i, cells_[i]) ^ cell_key(i, state);
+    cells_[i] = state;
+    ++revision_;
+
+    if (edits_.size() < kEditLog) {
+      edits_.push_back(static_cast<std::uint32_t>(i));
+    } else {
+      edits_.clear();
+      edit_base_ = revision_;
+    }
+  }
+
+  /** Resize to width x height with every cell `state`. */
+  void reset(
+    std::uint32_t width,
+    std::uint32_t height,
+    double resolution,
+    CellState state = CellState::Unknown
+  );
+
+  /**
+   * Replace shape and cells.
+   * @throws std::invalid_argument if cells.size() != width * height
+   */
+  void assign(
+    std::uint32_t width,
+    std::uint32_t height,
+    double resolution,
+    std::vector<CellState> cells
+  );
+
+  /** Set cells [first, first + count) of the row-major order to state. */
+  void fill(
+    std::size_t first,
+    std::size_t count,
+    CellState state
+  );
+
+  /**
+   * Number of cells in state s within the inclusive rectangle
+   * [x0, x1] x [y0, y1], in O(1) once the tables are built.
+   * The rectangle must lie inside the map.
+   */
+  std::uint32_t count(
+    std::uint32_t x0,
+    std::uint32_t y0,
+    std::uint32_t x1,
+    std::uint32_t y1,
+    CellState s
+  ) const;
+
+  bool region_free(
+    std::uint32_t x0,
+    std::uint32_t y0,
+    std::uint32_t x1,
+    std::uint32_t y1
+  ) const;
+
+  /**
+   * Summed-area tables for the current revision, built on first use
+   * and swapped in atomically so concurrent readers can share them.
+   */
+  std::shared_ptr<const OccupancySums> sums() const;
+
+  /**
+   * Distance field for the current revision. Patched from the previous
+   * one by brushfire when only a few cells changed through set(),
+   * otherwise reused from any map with the same occupancy, otherwise
+   * built from scratch.
+   */
+  std::shared_ptr<const DistanceField> distance_field() const;
+
+  /** Zobrist hash of the cells and the map shape, in O(1). */
+  std::uint64_t hash() const;
+
+  /** Bytes held by the cells and the edit log. */
+  std::size_t cell_bytes() const;
+
+  /**
+   * Bytes held by the summed-area tables and distance field. A field
+   * shared with other maps is counted in full by each of them.
+   */
+  std::size_t cache_bytes() const;
+
+  /** Release the derived tables; they are rebuilt on next use. */
+  void drop_caches();
+
+  /** Release spare capacity of the cells and the edit log. */
+  void shrink_to_fit();
+
+  /** Same shape and cells; revision and caches are ignored. */
+  bool operator==(const GridMap& other) const;
+
+  /** Zobrist key of cell i in state s. */
+  static std::uint64_t cell_key(std::size_t i, CellState s) {
+    std::uint64_t z = (static_cast<std::uint64_t>(i) << 2 |
+                       static_cast<std::uint64_t>(s)) + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
   }
+
+private:
+  struct FieldSlot {
+    std::uint64_t revision;
+    std::shared_ptr<const DistanceField> field;
+  };
+
+  /** Bulk write: bump the revision and restart the edit log. */
+  void touch();
+
+  std::vector<CellState> cells_;
+
+  // Bumped by every write; region queries rebuild their tables when
+  // it no longer matches.
+  std::uint64_t revision_ = 0;
+  std::uint64_t edit_base_ = 0;
+  std::vector<std::uint32_t> edits_;
+
+  // XOR of cell_key over the cells, kept current by every write.
+  std::uint64_t zobrist_ = 0;
+
+  mutable std::shared_ptr<const OccupancySums> sums_;
+  mutable std::shared_ptr<const FieldSlot> field_;
+};
+
+/**
+ * How a world holds its occupancy map.
+ */
+enum class MapStorage : std::uint8_t {
+  Dense,    // GridMap cells
+  Quadtree  // QuadtreeMap; uniform regions collapse
 };
 
 /**
@@ -57,7 +249,11 @@ struct GridMap {
 struct World {
   WorldId id;
 
+  // Dense storage: the cells live in `map` and `sparse_map` is null.
+  // Quadtree storage: the cells live in `sparse_map`, shared between
+  // copies of the world, and `map` is 0 x 0 with only the resolution.
   GridMap map;
+  std::shared_ptr<const QuadtreeMap> sparse_map;
 
   // Physical state
   std::unordered_map<Agent, Pose> poses;
@@ -65,12 +261,25 @@ struct World {
   // Intentional state (multi-agent planning)
   std::unordered_map<Agent, std::string> goals;
 
+  MapStorage map_storage() const {
+    return sparse_map ? MapStorage::Quadtree : MapStorage::Dense;
+  }
+
+  /** Convert the map to `storage`; the cells are unchanged. */
+  void store_map(MapStorage storage);
+
   /**
-   * Equality is structural: used for world merging.
+   * The map as a GridMap: `map` itself under dense storage, otherwise
+   * the quadtree expanded into `scratch`. For the serializers, which
+   * read cells directly.
    */
-  bool operator==(const World& other) const {
-    return id == other.id;
-  }
+  const GridMap& dense_map(GridMap& scratch) const;
+
+  /**
+   * Equality is structural (map, poses, goals; not the id): used for
+   * world merging. Maps compare by cells whatever their storage.
+   */
+  bool operator==(const World& other) const;
 };
 
 } // namespace epistemic
@@ -0,0 +1,358 @@
+#include "epistemic/async_update.hpp"
+#include "epistemic/query.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace epistemic {
+
+namespace {
+
+WorldId product_id(WorldId w, std::size_t e) {
+  return (static_cast<WorldId>(w) << 32) | static_cast<WorldId>(e);
+}
+
+struct Job {
+  BeliefState belief;
+  EventModel event_model;
+  UpdateOptions options;
+
+  std::promise<UpdateResult> result;
+  std::promise<UpdateResult> completion;
+
+  // Guards result_sent and partial; the deadline watchdog and the
+  // worker race to send the result.
+  std::mutex mutex;
+  std::condition_variable result_cv;
+  bool result_sent = false;
+
+  // Latest anytime snapshot, moved out if the deadline comes first.
+  std::optional<BeliefState> partial;
+
+  // Sends r unless a result went out already; false then.
+  bool send_result(UpdateResult r) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (result_sent) return false;
+      result_sent = true;
+      result.set_value(std::move(r));
+    }
+    result_cv.notify_all();
+    return true;
+  }
+
+  bool result_pending() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !result_sent;
+  }
+
+  // What the deadline hands out: the latest snapshot in anytime mode,
+  // an empty missed result otherwise. Requires mutex held.
+  UpdateResult deadline_result() {
+    UpdateResult r;
+    r.complete = false;
+    if (!options.anytime) {
+      r.deadline_missed = true;
+    } else if (partial) {
+      r.state = std::move(*partial);
+      partial.reset();
+    }
+    return r;
+  }
+};
+
+struct Candidate {
+  WorldId world;
+  std::size_t event; // index into event_model.events
+};
+
+// Edges built between two calls to the stop predicate.
+constexpr std::size_t kStopCheckInterval = 1024;
+
+/**
+ * Lookups built once per update. Out-edges are only indexed for
+ * anytime snapshots, so a snapshot visits the edges of its own worlds
+ * rather than the whole relation.
+ */
+struct Index {
+  std::unordered_map<WorldId, const World*> by_id;
+  std::vector<std::unordered_map<WorldId, std::vector<WorldId>>> out;
+
+  Index(const BeliefState& belief, bool with_edges) {
+    for (const World& w : belief.model.worlds) {
+      by_id.emplace(w.id, &w);
+    }
+    if (!with_edges) return;
+
+    const auto& accessibility = belief.model.accessibility;
+    out.resize(accessibility.size());
+    for (Agent agent = 0; agent < accessibility.size(); ++agent) {
+      for (const auto& [w1, w2] : accessibility[agent]) {
+        out[agent][w1].push_back(w2);
+      }
+    }
+  }
+};
+
+// Product restricted to the first `count` accepted candidates, or
+// nullopt once stop() returns true. Walks index.out when it is built.
+template <typename Stop>
+std::optional<BeliefState> build_state(
+  const Job& job,
+  const Index& index,
+  const std::vector<Candidate>& accepted,
+  std::size_t count,
+  Stop&& stop
+) {
+  const BeliefState& belief = job.belief;
+  const EventModel& em = job.event_model;
+  const auto& by_id = index.by_id;
+
+  BeliefState updated;
+  std::unordered_map<WorldId, std::vector<std::size_t>> events_at;
+
+  for (std::size_t k = 0; k < count; ++k) {
+    const Candidate& c = accepted[k];
+    auto it = by_id.find(c.world);
+    if (it == by_id.end()) continue;
+
+    World new_world = *it->second;
+    new_world.id = product_id(c.world, em.events[c.event].id);
+
+    updated.model.worlds.push_back(new_world);
+    updated.designated.push_back(new_world.id);
+    events_at[c.world].push_back(c.event);
+  }
+
+  // ((w1,e1),(w2,e2)) iff w1 R_a w2, e1 R^E_a e2 and both exist
+  const auto& accessibility = belief.model.accessibility;
+  updated.model.accessibility.resize(accessibility.size());
+
+  std::size_t since_check = 0;
+  auto add_edges = [&](Agent agent, WorldId w1, WorldId w2) {
+    auto from = events_at.find(w1);
+    auto to = events_at.find(w2);
+    if (from == events_at.end() || to == events_at.end()) return;
+
+    for (std::size_t e1 : from->second) {
+      for (std::size_t e2 : to->second) {
+        if (!em.accessible(agent, em.events[e1].id, em.events[e2].id)) {
+          continue;
+        }
+        updated.model.accessibility[agent].push_back({
+          product_id(w1, em.events[e1].id),
+          product_id(w2, em.events[e2].id)
+        });
+      }
+    }
+  };
+
+  for (Agent agent = 0; agent < accessibility.size(); ++agent) {
+    if (index.out.empty()) {
+      for (const auto& [w1, w2] : accessibility[agent]) {
+        if (++since_check == kStopCheckInterval) {
+          since_check = 0;
+          if (stop()) return std::nullopt;
+        }
+        add_edges(agent, w1, w2);
+      }
+      continue;
+    }
+
+    for (const auto& [w1, events] : events_at) {
+      auto out = index.out[agent].find(w1);
+      if (out == index.out[agent].end()) continue;
+
+      for (WorldId w2 : out->second) {
+        if (++since_check == kStopCheckInterval) {
+          since_check = 0;
+          if (stop()) return std::nullopt;
+        }
+        add_edges(agent, w1, w2);
+      }
+    }
+  }
+
+  return updated;
+}
+
+/**
+ * Sends the deadline result unless the worker sent one first. Runs on
+ * its own thread, so the deadline holds even while the task waits for
+ * a pool worker.
+ */
+void watch_deadline(const std::shared_ptr<Job>& job) {
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->result_cv.wait_until(lock, job->options.deadline, [&] { return job->result_sent; });
+  if (job->result_sent) return;
+
+  job->result_sent = true;
+  job->result.set_value(job->deadline_result());
+}
+
+void run(Job& job) {
+  const UpdateOptions& opt = job.options;
+  const auto& events = job.event_model.events;
+
+  // Heaviest events first; stable so ties keep model order.
+  std::vector<std::size_t> order(events.size());
+  for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return events[a].weight > events[b].weight;
+  });
+
+  std::vector<Candidate> accepted;
+  bool abandoned = false;
+
+  auto give_up = [&](bool missed) {
+    abandoned = true;
+    UpdateResult r;
+    r.complete = false;
+    r.cancelled = !missed;
+    r.deadline_missed = missed;
+    job.send_result(r);
+    job.completion.set_value(r);
+  };
+
+  auto past_deadline = [&]() {
+    return UpdateOptions::Clock::now() >= opt.deadline;
+  };
+
+  // Anytime snapshots are rebuilt whenever the accepted candidates
+  // double, which keeps their total cost linear in the final product.
+  const bool snapshots = opt.anytime && opt.deadline != UpdateOptions::Clock::time_point::max();
+  const std::size_t cap = opt.max_partial_worlds
+    ? opt.max_partial_worlds
+    : std::numeric_limits<std::size_t>::max();
+  std::size_t snapshot_at = 1;
+  std::size_t snapshot_size = 0;
+
+  const Index index(job.belief, false);
+  std::optional<Index> snapshot_index;
+
+  auto take_snapshot = [&]() {
+    if (!snapshot_index) snapshot_index.emplace(job.belief, true);
+
+    const std::size_t count = std::min(accepted.size(), cap);
+    auto state = build_state(job, *snapshot_index, accepted, count, [&] {
+      return opt.cancel.cancelled() || !job.result_pending();
+    });
+    if (!state) return;
+
+    // The previous snapshot is freed after the lock is released, so
+    // the watchdog never waits on it.
+    std::lock_guard<std::mutex> lock(job.mutex);
+    if (job.result_sent) return;
+    job.partial.swap(state);
+    snapshot_size = count;
+  };
+
+  // Sends the deadline result if it is due; false if the update is
+  // abandoned (not anytime).
+  auto check_deadline = [&]() {
+    if (!past_deadline()) return true;
+    if (!opt.anytime) {
+      give_up(true);
+      return false;
+    }
+
+    std::unique_lock<std::mutex> lock(job.mutex);
+    if (!job.result_sent) {
+      job.result_sent = true;
+      job.result.set_value(job.deadline_result());
+      lock.unlock();
+      job.result_cv.notify_all();
+    }
+    return true;
+  };
+
+  for (std::size_t e : order) {
+    for (WorldId w : job.belief.designated) {
+      if (opt.cancel.cancelled()) {
+        give_up(false);
+        return;
+      }
+
+      if (holds(job.belief, w, events[e].precondition)) {
+        accepted.push_back({w, e});
+
+        if (snapshots && accepted.size() >= snapshot_at &&
+            snapshot_size < cap && job.result_pending()) {
+          take_snapshot();
+          snapshot_at = 2 * accepted.size();
+        }
+      }
+
+      if (!check_deadline()) return;
+    }
+  }
+
+  // The edge pass can dominate, so it watches the deadline too. In
+  // anytime mode the deadline only sends the snapshot; the full
+  // product is built once and becomes the completion.
+  const Index& full_index = snapshot_index ? *snapshot_index : index;
+  std::optional<BeliefState> state = build_state(job, full_index, accepted, accepted.size(), [&] {
+    return opt.cancel.cancelled() || !check_deadline();
+  });
+
+  if (!state) {
+    if (!abandoned) give_up(false);
+    return;
+  }
+
+  UpdateResult full;
+  full.state = std::move(*state);
+
+  job.send_result(full);
+  job.completion.set_value(std::move(full));
+}
+
+} // namespace
+
+AsyncUpdate product_update_async(
+  BeliefState belief,
+  EventModel event_model,
+  ThreadPool& pool,
+  UpdateOptions options
+) {
+  auto job = std::make_shared<Job>();
+  job->belief = std::move(belief);
+  job->event_model = std::move(event_model);
+  job->options = options;
+
+  AsyncUpdate handle;
+  handle.result = job->result.get_future();
+  handle.completion = job->completion.get_future().share();
+  handle.cancel = options.cancel;
+
+  if (options.deadline != UpdateOptions::Clock::time_point::max()) {
+    std::thread([job] { watch_deadline(job); }).detach();
+  }
+
+  pool.submit([job]() {
+    try {
+      run(*job);
+    } catch (...) {
+      {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        if (!job->result_sent) {
+          job->result_sent = true;
+          job->result.set_exception(std::current_exception());
+        }
+      }
+      job->result_cv.notify_all();
+      job->completion.set_exception(std::current_exception());
+    }
+  });
+
+  return handle;
+}
+
+} // namespace epistemic
@@ -1,41 +1,212 @@
 #include "epistemic/atom_interpretation.hpp"
+#include "epistemic/slam_events/raycast.hpp"
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 namespace epistemic {
 
+namespace {
+
+/**
+ * Integer arguments of "name(a,b,...)". Returns false on a
+ * malformed atom.
+ */
+bool parse_args(
+  const std::string& s,
+  std::vector<int>& args
+) {
+  auto l = s.find('(');
+  auto r = s.find(')', l);
+
+  if (l == std::string::npos || r == std::string::npos) {
+    return false;
+  }
+
+  std::stringstream in(s.substr(l + 1, r - l - 1));
+  std::string field;
+  while (std::getline(in, field, ',')) {
+    try {
+      args.push_back(std::stoi(field));
+    } catch (const std::exception&) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::uint32_t map_width(const GridMap& map) { return map.width; }
+std::uint32_t map_height(const GridMap& map) { return map.height; }
+std::uint32_t map_width(const QuadtreeMap& map) { return map.width(); }
+std::uint32_t map_height(const QuadtreeMap& map) { return map.height(); }
+
+template <typename Map>
+bool in_bounds(const Map& map, int x, int y) {
+  return x >= 0 && y >= 0 &&
+         x < static_cast<int>(map_width(map)) &&
+         y < static_cast<int>(map_height(map));
+}
+
+/**
+ * Parse "(x0,y0,x1,y1,...)" into an in-bounds, ordered rectangle.
+ */
+template <typename Map>
+bool parse_region(
+  const Map& map,
+  const std::vector<int>& args,
+  std::uint32_t& x0,
+  std::uint32_t& y0,
+  std::uint32_t& x1,
+  std::uint32_t& y1
+) {
+  if (args.size() < 4 ||
+      !in_bounds(map, args[0], args[1]) ||
+      !in_bounds(map, args[2], args[3])) {
+    return false;
+  }
+
+  x0 = std::min(args[0], args[2]);
+  x1 = std::max(args[0], args[2]);
+  y0 = std::min(args[1], args[3]);
+  y1 = std::max(args[1], args[3]);
+  return true;
+}
+
+/**
+ * Cell and region atoms, shared by every map representation. Sets
+ * `matched` when s names one of them.
+ */
+template <typename Map>
+bool interpret_map_atom(
+  const Map& map,
+  const std::string& s,
+  bool& matched
+) {
+  std::vector<int> args;
+  matched = true;
+
+  if (s.rfind("cell_free", 0) == 0) {
+    if (!parse_args(s, args) || args.size() != 2 ||
+        !in_bounds(map, args[0], args[1])) {
+      return false;
+    }
+
+    return map.at(args[0], args[1]) == CellState::Free;
+  }
+
+  // Region atoms: GridMap answers from its summed-area tables in O(1),
+  // QuadtreeMap by visiting the nodes along the rectangle's border.
+  std::uint32_t x0, y0, x1, y1;
+
+  if (s.rfind("region_free", 0) == 0) {
+    if (!parse_args(s, args) || args.size() != 4 ||
+        !parse_region(map, args, x0, y0, x1, y1)) {
+      return false;
+    }
+
+    return map.region_free(x0, y0, x1, y1);
+  }
+
+  // unknown_at_most(x0,y0,x1,y1,k): at most k unexplored cells
+  if (s.rfind("unknown_at_most", 0) == 0) {
+    if (!parse_args(s, args) || args.size() != 5 || args[4] < 0 ||
+        !parse_region(map, args, x0, y0, x1, y1)) {
+      return false;
+    }
+
+    return map.count(x0, y0, x1, y1, CellState::Unknown) <=
+           static_cast<std::uint32_t>(args[4]);
+  }
+
+  matched = false;
+  return false;
+}
+
+} // namespace
+
+bool parse_agent_at(
+  const Atom& atom,
+  AgentAtAtom& out
+) {
+  const std::string& s = atom.name;
+  if (s.rfind("agent_at(", 0) != 0) {
+    return false;
+  }
+
+  std::vector<int> args;
+  if (!parse_args(s, args) || args.size() != 3 || args[0] < 0) {
+    return false;
+  }
+
+  out = AgentAtAtom{static_cast<Agent>(args[0]), args[1], args[2]};
+  return true;
+}
+
 bool interpret_atom(
   const World& world,
   const Atom& atom
 ) {
   const std::string& s = atom.name;
 
-  if (s.rfind("cell_free", 0) == 0) {
-    // Parse coordinates
-    auto l = s.find('(');
-    auto c = s.find(',');
-    auto r = s.find(')');
+  // Precondition of skip events ("nothing happened")
+  if (s == "true") {
+    return true;
+  }
+
+  bool matched = false;
+  const bool value = world.sparse_map
+    ? interpret_map_atom(*world.sparse_map, s, matched)
+    : interpret_map_atom(world.map, s, matched);
+  if (matched) {
+    return value;
+  }
+
+  // lidar_bin_i: beam i of the active scan agrees with this world's map
+  if (s.rfind("lidar_bin_", 0) == 0) {
+    const ScanConsistency* scan = ActiveScan::current();
+    if (!scan) {
+      return false;
+    }
 
-    if (l == std::string::npos ||
-        c == std::string::npos ||
-        r == std::string::npos) {
+    try {
+      return scan->consistent(world.id, std::stoul(s.substr(10)));
+    } catch (const std::exception&) {
       return false;
     }
+  }
 
-    int x = std::stoi(s.substr(l + 1, c - l - 1));
-    int y = std::stoi(s.substr(c + 1, r - c - 1));
+  if (s.rfind("agent_at(", 0) == 0) {
+    AgentAtAtom at;
+    if (!parse_agent_at(atom, at)) {
+      return false;
+    }
 
-    if (x < 0 || y < 0 ||
-        x >= static_cast<int>(world.map.width) ||
-        y >= static_cast<int>(world.map.height)) {
+    auto it = world.poses.find(at.agent);
+    if (it == world.poses.end()) {
       return false;
     }
 
-    return world.map.at(x, y) == CellState::Free;
+    const double r = world.map.resolution;
+    const Pose& p = it->second;
+    return at.x0(r) <= p.x && p.x < at.x1(r) &&
+           at.y0(r) <= p.y && p.y < at.y1(r);
   }
 
   // Unknown atom → false
   return false;
 }
 
+bool interpret_atom(
+  const QuadtreeMap& map,
+  const Atom& atom
+) {
+  if (atom.name == "true") {
+    return true;
+  }
+
+  bool matched = false;
+  return interpret_map_atom(map, atom.name, matched);
+}
+
 } // namespace epistemic
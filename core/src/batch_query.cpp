@@ -0,0 +1,304 @@
+#include "epistemic/batch_query.hpp"
+#include "epistemic/atom_interpretation.hpp"
+#include "epistemic/pose_table.hpp"
+#include "epistemic/query.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <variant>
+
+namespace epistemic {
+
+namespace {
+
+constexpr std::size_t kWorldGrain = 256;
+
+enum class NodeKind : std::uint8_t {
+  Atom,
+  Not,
+  And,
+  Knows,
+  Distributed,
+  False
+};
+
+struct Node {
+  NodeKind kind = NodeKind::False;
+  const Formula* formula = nullptr;
+  std::size_t left = 0;
+  std::size_t right = 0;
+  Agent agent = 0;
+  AgentMask group = 0;
+  std::size_t height = 0;
+};
+
+// Hash-consed DAG of every subformula in the batch. A node is reused
+// only when formula_equal confirms the hash match.
+class FormulaDag {
+public:
+  std::size_t intern(const Formula& phi) {
+    const std::size_t h = formula_hash(phi);
+    auto range = index_.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (formula_equal(*nodes_[it->second].formula, phi)) return it->second;
+    }
+
+    Node node;
+    node.formula = &phi;
+
+    std::visit([&](auto&& arg) {
+      using T = std::decay_t<decltype(arg)>;
+
+      if constexpr (std::is_same_v<T, Atom>) {
+        node.kind = NodeKind::Atom;
+      }
+      else if constexpr (std::is_same_v<T, Not>) {
+        node.kind = NodeKind::Not;
+        node.left = intern(*arg.phi);
+        node.height = nodes_[node.left].height + 1;
+      }
+      else if constexpr (std::is_same_v<T, And>) {
+        node.kind = NodeKind::And;
+        node.left = intern(*arg.left);
+        node.right = intern(*arg.right);
+        node.height = std::max(
+          nodes_[node.left].height,
+          nodes_[node.right].height
+        ) + 1;
+      }
+      else if constexpr (std::is_same_v<T, Knows>) {
+        node.kind = NodeKind::Knows;
+        node.agent = arg.agent;
+        node.left = intern(*arg.phi);
+        node.height = nodes_[node.left].height + 1;
+      }
+      else if constexpr (std::is_same_v<T, DistributedKnowledge>) {
+        node.kind = NodeKind::Distributed;
+        node.group = arg.group;
+        node.left = intern(*arg.phi);
+        node.height = nodes_[node.left].height + 1;
+      }
+      else {
+        node.kind = NodeKind::False;
+      }
+    }, phi.value);
+
+    nodes_.push_back(node);
+    index_.emplace(h, nodes_.size() - 1);
+    return nodes_.size() - 1;
+  }
+
+  const std::vector<Node>& nodes() const { return nodes_; }
+
+private:
+  std::vector<Node> nodes_;
+  std::unordered_multimap<std::size_t, std::size_t> index_;
+};
+
+} // namespace
+
+BatchResult holds_batch(
+  const BeliefState& belief,
+  const std::vector<const Formula*>& formulas,
+  ThreadPool& pool
+) {
+  BatchResult result;
+  result.worlds = belief.designated;
+  result.formula_count = formulas.size();
+
+  const std::size_t W = belief.designated.size();
+  result.values.assign(formulas.size() * W, 0);
+  if (W == 0 || formulas.empty()) return result;
+
+  FormulaDag dag;
+  std::vector<std::size_t> roots;
+  roots.reserve(formulas.size());
+  for (const Formula* phi : formulas) {
+    roots.push_back(dag.intern(*phi));
+  }
+  const auto& nodes = dag.nodes();
+
+  // Column -> World (and its model.worlds row). Missing worlds make
+  // every formula false, as in holds.
+  const auto& worlds = belief.model.worlds;
+  std::unordered_map<WorldId, std::size_t> by_id;
+  for (std::size_t row = 0; row < worlds.size(); ++row) {
+    by_id.emplace(worlds[row].id, row);
+  }
+
+  std::unordered_map<WorldId, std::size_t> column;
+  std::vector<const World*> world_at(W, nullptr);
+  std::vector<std::size_t> row_at(W, 0);
+  for (std::size_t i = 0; i < W; ++i) {
+    column.emplace(belief.designated[i], i);
+    auto it = by_id.find(belief.designated[i]);
+    if (it != by_id.end()) {
+      world_at[i] = &worlds[it->second];
+      row_at[i] = it->second;
+    }
+  }
+
+  // Per-agent successor lists restricted to designated worlds,
+  // built once instead of scanning the relation per Knows check.
+  // Indexed by agent; empty for agents no modal node mentions.
+  // Sorted, so Distributed nodes can intersect them.
+  std::vector<std::vector<std::vector<std::size_t>>> succ;
+  auto build_succ = [&](Agent a) {
+    if (a >= succ.size()) succ.resize(a + 1);
+    auto& lists = succ[a];
+    if (!lists.empty()) return;
+    lists.resize(W);
+
+    if (a >= belief.model.accessibility.size()) return;
+
+    for (const auto& [w1, w2] : belief.model.accessibility[a]) {
+      auto c1 = column.find(w1);
+      auto c2 = column.find(w2);
+      if (c1 == column.end() || c2 == column.end()) continue;
+      lists[c1->second].push_back(c2->second);
+    }
+    for (auto& list : lists) std::sort(list.begin(), list.end());
+  };
+
+  for (const Node& n : nodes) {
+    if (n.kind == NodeKind::Knows) build_succ(n.agent);
+    if (n.kind == NodeKind::Distributed) for_each_agent(n.group, build_succ);
+  }
+
+  std::vector<std::vector<std::uint8_t>> truth(nodes.size());
+
+  std::size_t max_height = 0;
+  for (const Node& n : nodes) max_height = std::max(max_height, n.height);
+
+  std::vector<std::vector<std::size_t>> levels(max_height + 1);
+  for (std::size_t k = 0; k < nodes.size(); ++k) {
+    levels[nodes[k].height].push_back(k);
+    truth[k].assign(W, 0);
+  }
+
+  // agent_at atoms read one pose column of a PoseTable instead of each
+  // world's pose map, as long as every world uses the same resolution
+  // (the box bounds are then the same doubles for all of them). With no
+  // worlds at all every designated id is dangling and the atoms are
+  // false anyway.
+  std::vector<std::uint8_t> precomputed(nodes.size(), 0);
+  {
+    bool uniform = !worlds.empty();
+    for (const World& w : worlds) {
+      uniform = uniform && w.map.resolution == worlds.front().map.resolution;
+    }
+
+    std::unique_ptr<PoseTable> poses;
+    AgentAtAtom at;
+    for (std::size_t k = 0; uniform && k < nodes.size(); ++k) {
+      if (nodes[k].kind != NodeKind::Atom ||
+          !parse_agent_at(std::get<Atom>(nodes[k].formula->value), at)) {
+        continue;
+      }
+
+      if (!poses) poses = std::make_unique<PoseTable>(belief);
+      const double r = worlds.front().map.resolution;
+      const auto mask = poses->box_mask(
+        at.agent, at.x0(r), at.y0(r), at.x1(r), at.y1(r));
+
+      for (std::size_t i = 0; i < W; ++i) {
+        truth[k][i] = world_at[i] && mask[row_at[i]];
+      }
+      precomputed[k] = 1;
+    }
+  }
+
+  const std::size_t chunks = (W + kWorldGrain - 1) / kWorldGrain;
+
+  for (const auto& level : levels) {
+    pool.parallel_for(level.size() * chunks, [&](std::size_t job) {
+      const std::size_t k = level[job / chunks];
+      const Node& n = nodes[k];
+      if (precomputed[k]) return;
+
+      const std::size_t begin = (job % chunks) * kWorldGrain;
+      const std::size_t end = std::min(W, begin + kWorldGrain);
+
+      auto& out = truth[k];
+
+      for (std::size_t i = begin; i < end; ++i) {
+        if (!world_at[i]) continue;
+
+        switch (n.kind) {
+          case NodeKind::Atom:
+            out[i] = interpret_atom(
+              *world_at[i],
+              std::get<Atom>(n.formula->value)
+            );
+            break;
+
+          case NodeKind::Not:
+            out[i] = !truth[n.left][i];
+            break;
+
+          case NodeKind::And:
+            out[i] = truth[n.left][i] && truth[n.right][i];
+            break;
+
+          case NodeKind::Knows: {
+            const auto& sub = truth[n.left];
+            bool known = true;
+            for (std::size_t j : succ[n.agent][i]) {
+              if (!sub[j]) {
+                known = false;
+                break;
+              }
+            }
+            out[i] = known;
+            break;
+          }
+
+          case NodeKind::Distributed: {
+            // Walk the first agent's successors; keep those every
+            // other agent in the group shares.
+            const auto& sub = truth[n.left];
+            bool known = true;
+
+            if (n.group == 0) {
+              for (std::size_t j = 0; j < W && known; ++j) known = sub[j];
+              out[i] = known;
+              break;
+            }
+
+            for (std::size_t j : succ[lowest_agent(n.group)][i]) {
+              if (sub[j]) continue;
+              bool shared = true;
+              for_each_agent(n.group, [&](Agent a) {
+                const auto& list = succ[a][i];
+                shared = shared &&
+                  std::binary_search(list.begin(), list.end(), j);
+              });
+              if (shared) {
+                known = false;
+                break;
+              }
+            }
+            out[i] = known;
+            break;
+          }
+
+          case NodeKind::False:
+            break;
+        }
+      }
+    });
+  }
+
+  for (std::size_t f = 0; f < roots.size(); ++f) {
+    std::copy(
+      truth[roots[f]].begin(),
+      truth[roots[f]].end(),
+      result.values.begin() + f * W
+    );
+  }
+
+  return result;
+}
+
+} // namespace epistemic
@@ -0,0 +1,240 @@
+#include "epistemic/bdd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace epistemic {
+
+namespace {
+
+constexpr BddVar kTerminalVar = std::numeric_limits<BddVar>::max();
+
+enum QuantOp : std::uint64_t {
+  kExists = 1,
+  kAndExists = 2
+};
+
+} // namespace
+
+BddManager::BddManager() {
+  nodes_.push_back({kTerminalVar, kBddFalse, kBddFalse});
+  nodes_.push_back({kTerminalVar, kBddTrue, kBddTrue});
+}
+
+BddRef BddManager::mk(BddVar v, BddRef lo, BddRef hi) {
+  if (lo == hi) return lo;
+
+  const Key3 key{
+    static_cast<std::uint64_t>(v),
+    (static_cast<std::uint64_t>(lo) << 32) | hi
+  };
+
+  auto it = unique_.find(key);
+  if (it != unique_.end()) return it->second;
+
+  const BddRef r = static_cast<BddRef>(nodes_.size());
+  nodes_.push_back({v, lo, hi});
+  unique_.emplace(key, r);
+  return r;
+}
+
+BddRef BddManager::var(BddVar v) {
+  return mk(v, kBddFalse, kBddTrue);
+}
+
+BddRef BddManager::nvar(BddVar v) {
+  return mk(v, kBddTrue, kBddFalse);
+}
+
+BddRef BddManager::negate(BddRef f) {
+  return ite(f, kBddFalse, kBddTrue);
+}
+
+BddRef BddManager::apply_and(BddRef f, BddRef g) {
+  return ite(f, g, kBddFalse);
+}
+
+BddRef BddManager::apply_or(BddRef f, BddRef g) {
+  return ite(f, kBddTrue, g);
+}
+
+BddRef BddManager::ite(BddRef f, BddRef g, BddRef h) {
+  // Terminal cases
+  if (f == kBddTrue) return g;
+  if (f == kBddFalse) return h;
+  if (g == h) return g;
+  if (g == kBddTrue && h == kBddFalse) return f;
+
+  const Key3 key{
+    static_cast<std::uint64_t>(f),
+    (static_cast<std::uint64_t>(g) << 32) | h
+  };
+
+  auto it = ite_cache_.find(key);
+  if (it != ite_cache_.end()) return it->second;
+
+  const BddVar v = std::min({top(f), top(g), top(h)});
+
+  const BddRef lo = ite(low(f, v), low(g, v), low(h, v));
+  const BddRef hi = ite(high(f, v), high(g, v), high(h, v));
+  const BddRef r = mk(v, lo, hi);
+
+  ite_cache_.emplace(key, r);
+  return r;
+}
+
+BddRef BddManager::cube(const std::vector<BddVar>& vars) {
+  std::vector<BddVar> sorted = vars;
+  std::sort(sorted.begin(), sorted.end());
+
+  BddRef r = kBddTrue;
+  for (auto it = sorted.rbegin(); it != sorted.rend(); ++it) {
+    r = mk(*it, kBddFalse, r);
+  }
+  return r;
+}
+
+BddRef BddManager::exists(BddRef f, BddRef cube) {
+  if (f == kBddFalse || f == kBddTrue || cube == kBddTrue) return f;
+
+  // Skip quantified variables above f's top variable
+  while (cube != kBddTrue && top(cube) < top(f)) {
+    cube = nodes_[cube].hi;
+  }
+  if (cube == kBddTrue) return f;
+
+  const Key3 key{
+    (kExists << 32) | f,
+    static_cast<std::uint64_t>(cube)
+  };
+
+  auto it = quant_cache_.find(key);
+  if (it != quant_cache_.end()) return it->second;
+
+  const BddVar v = top(f);
+  BddRef r;
+
+  if (top(cube) == v) {
+    const BddRef rest = nodes_[cube].hi;
+    r = apply_or(exists(nodes_[f].lo, rest), exists(nodes_[f].hi, rest));
+  } else {
+    r = mk(v, exists(nodes_[f].lo, cube), exists(nodes_[f].hi, cube));
+  }
+
+  quant_cache_.emplace(key, r);
+  return r;
+}
+
+BddRef BddManager::and_exists(BddRef f, BddRef g, BddRef cube) {
+  if (f == kBddFalse || g == kBddFalse) return kBddFalse;
+  if (f == kBddTrue) return exists(g, cube);
+  if (g == kBddTrue || f == g) return exists(f, cube);
+  if (f > g) std::swap(f, g);
+
+  const BddVar v = std::min(top(f), top(g));
+
+  while (cube != kBddTrue && top(cube) < v) {
+    cube = nodes_[cube].hi;
+  }
+  if (cube == kBddTrue) return apply_and(f, g);
+
+  // Low 32 bits of the first word hold f; the second word packs g|cube.
+  const Key3 key{
+    (kAndExists << 32) | f,
+    (static_cast<std::uint64_t>(g) << 32) | cube
+  };
+
+  auto it = quant_cache_.find(key);
+  if (it != quant_cache_.end()) return it->second;
+
+  BddRef r;
+  if (top(cube) == v) {
+    const BddRef rest = nodes_[cube].hi;
+    const BddRef lo = and_exists(low(f, v), low(g, v), rest);
+    r = (lo == kBddTrue)
+      ? kBddTrue
+      : apply_or(lo, and_exists(high(f, v), high(g, v), rest));
+  } else {
+    r = mk(
+      v,
+      and_exists(low(f, v), low(g, v), cube),
+      and_exists(high(f, v), high(g, v), cube)
+    );
+  }
+
+  quant_cache_.emplace(key, r);
+  return r;
+}
+
+BddRef BddManager::rename(BddRef f, const std::vector<BddVar>& map) {
+  std::unordered_map<BddRef, BddRef> memo;
+  return rename_rec(f, map, memo);
+}
+
+BddRef BddManager::rename_rec(
+  BddRef f,
+  const std::vector<BddVar>& map,
+  std::unordered_map<BddRef, BddRef>& memo
+) {
+  if (f == kBddFalse || f == kBddTrue) return f;
+
+  auto it = memo.find(f);
+  if (it != memo.end()) return it->second;
+
+  const BddVar v = top(f);
+  const BddVar target = v < map.size() ? map[v] : v;
+
+  // ite keeps the result ordered even if the map is not monotone.
+  const BddRef r = ite(
+    var(target),
+    rename_rec(nodes_[f].hi, map, memo),
+    rename_rec(nodes_[f].lo, map, memo)
+  );
+
+  memo.emplace(f, r);
+  return r;
+}
+
+long double BddManager::sat_count(BddRef f, BddVar nvars) {
+  std::unordered_map<BddRef, long double> memo;
+  const BddVar first = (f <= kBddTrue) ? nvars : top(f);
+  return sat_count_rec(f, nvars, memo) * std::pow(2.0L, first);
+}
+
+long double BddManager::sat_count_rec(
+  BddRef f,
+  BddVar nvars,
+  std::unordered_map<BddRef, long double>& memo
+) {
+  if (f == kBddFalse) return 0.0L;
+  if (f == kBddTrue) return 1.0L;
+
+  auto it = memo.find(f);
+  if (it != memo.end()) return it->second;
+
+  auto branch = [&](BddRef child) {
+    const BddVar next = (child <= kBddTrue) ? nvars : top(child);
+    return sat_count_rec(child, nvars, memo) *
+           std::pow(2.0L, next - top(f) - 1);
+  };
+
+  const long double r = branch(nodes_[f].lo) + branch(nodes_[f].hi);
+  memo.emplace(f, r);
+  return r;
+}
+
+bool BddManager::eval(BddRef f, const std::vector<bool>& assignment) const {
+  while (f > kBddTrue) {
+    const Node& n = nodes_[f];
+    f = (n.var < assignment.size() && assignment[n.var]) ? n.hi : n.lo;
+  }
+  return f == kBddTrue;
+}
+
+void BddManager::clear_caches() {
+  ite_cache_.clear();
+  quant_cache_.clear();
+}
+
+} // namespace epistemic
@@ -0,0 +1,605 @@
+#include "epistemic/belief_delta.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace epistemic {
+
+namespace {
+
+constexpr std::uint8_t kMagic[4] = {'E', 'B', 'D', '1'};
+
+// Decoded edges resize the relation vector to their agent, so agent
+// indices are bounded too.
+constexpr std::uint32_t kMaxDeltaAgents = 1u << 16;
+
+// ---- cell runs ----------------------------------------------------------
+
+std::vector<CellRun> diff_cells(
+  const std::vector<CellState>* base,
+  const std::vector<CellState>& cells
+) {
+  std::vector<CellRun> runs;
+
+  for (std::uint32_t i = 0; i < cells.size(); ++i) {
+    const CellState before = base ? (*base)[i] : CellState::Unknown;
+    if (cells[i] == before) continue;
+
+    if (!runs.empty() &&
+        runs.back().start + runs.back().length == i &&
+        runs.back().state == cells[i]) {
+      ++runs.back().length;
+    } else {
+      runs.push_back({i, 1, cells[i]});
+    }
+  }
+  return runs;
+}
+
+WorldDelta make_world_delta(const World& w, const World* parent) {
+  GridMap scratch;
+  const GridMap& map = w.dense_map(scratch);
+
+  GridMap parent_scratch;
+  const GridMap* base = parent ? &parent->dense_map(parent_scratch) : nullptr;
+
+  WorldDelta d;
+  d.id = w.id;
+  d.width = map.width;
+  d.height = map.height;
+  d.resolution = map.resolution;
+
+  const bool same_shape = base &&
+    base->width == map.width &&
+    base->height == map.height &&
+    base->cells().size() == map.cells().size();
+
+  if (same_shape) {
+    d.has_parent = true;
+    d.parent = parent->id;
+  }
+  d.cells = diff_cells(same_shape ? &base->cells() : nullptr, map.cells());
+
+  d.poses.assign(w.poses.begin(), w.poses.end());
+  d.goals.assign(w.goals.begin(), w.goals.end());
+  return d;
+}
+
+bool same_content(const World& a, const World& b) {
+  if (a.sparse_map || b.sparse_map) {
+    return a == b;
+  }
+  if (a.map.width != b.map.width || a.map.height != b.map.height ||
+      a.map.resolution != b.map.resolution || a.map.cells() != b.map.cells() ||
+      a.goals != b.goals || a.poses.size() != b.poses.size()) {
+    return false;
+  }
+  for (const auto& [agent, p] : a.poses) {
+    auto it = b.poses.find(agent);
+    if (it == b.poses.end() || it->second.x != p.x ||
+        it->second.y != p.y || it->second.theta != p.theta) {
+      return false;
+    }
+  }
+  return true;
+}
+
+World materialize(const WorldDelta& d, const World* parent) {
+  World w;
+  w.id = d.id;
+
+  const std::size_t n = static_cast<std::size_t>(d.width) * d.height;
+  if (d.has_parent) {
+    GridMap scratch;
+    const GridMap* base = parent ? &parent->dense_map(scratch) : nullptr;
+    if (!base || base->cells().size() != n) {
+      throw std::runtime_error("Delta parent world missing or reshaped");
+    }
+    w.map.assign(d.width, d.height, d.resolution, base->cells());
+  } else {
+    w.map.reset(d.width, d.height, d.resolution);
+  }
+
+  for (const CellRun& run : d.cells) {
+    if (static_cast<std::size_t>(run.start) + run.length > n) {
+      throw std::runtime_error("Delta cell run out of bounds");
+    }
+    w.map.fill(run.start, run.length, run.state);
+  }
+
+  w.poses.insert(d.poses.begin(), d.poses.end());
+  w.goals.insert(d.goals.begin(), d.goals.end());
+  return w;
+}
+
+// ---- edges --------------------------------------------------------------
+
+struct EdgeHash {
+  std::size_t operator()(const std::pair<WorldId, WorldId>& e) const {
+    return std::hash<WorldId>{}(e.first * 0x9e3779b97f4a7c15ULL ^ e.second);
+  }
+};
+
+using EdgeSet = std::unordered_set<std::pair<WorldId, WorldId>, EdgeHash>;
+
+// ---- binary encoding ----------------------------------------------------
+
+class Writer {
+public:
+  void u8(std::uint8_t v) { out_.push_back(v); }
+
+  void varint(std::uint64_t v) {
+    while (v >= 0x80) {
+      out_.push_back(static_cast<std::uint8_t>(v | 0x80));
+      v >>= 7;
+    }
+    out_.push_back(static_cast<std::uint8_t>(v));
+  }
+
+  void f64(double d) {
+    std::uint64_t u;
+    std::memcpy(&u, &d, sizeof u);
+    for (int i = 0; i < 8; ++i) out_.push_back(static_cast<std::uint8_t>(u >> (8 * i)));
+  }
+
+  void fixed64(std::uint64_t u) {
+    for (int i = 0; i < 8; ++i) out_.push_back(static_cast<std::uint8_t>(u >> (8 * i)));
+  }
+
+  void str(const std::string& s) {
+    varint(s.size());
+    out_.insert(out_.end(), s.begin(), s.end());
+  }
+
+  // Sorted ids as first value + gaps
+  void ids(std::vector<WorldId> v) {
+    std::sort(v.begin(), v.end());
+    varint(v.size());
+    WorldId prev = 0;
+    for (WorldId id : v) {
+      varint(id - prev);
+      prev = id;
+    }
+  }
+
+  std::vector<std::uint8_t> take() { return std::move(out_); }
+
+private:
+  std::vector<std::uint8_t> out_;
+};
+
+class Reader {
+public:
+  Reader(const std::uint8_t* data, std::size_t size)
+    : p_(data), end_(data + size) {}
+
+  std::uint8_t u8() {
+    need(1);
+    return *p_++;
+  }
+
+  std::uint64_t varint() {
+    std::uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const std::uint8_t b = u8();
+      v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+      if (!(b & 0x80)) return v;
+    }
+    throw std::runtime_error("Malformed varint in belief delta");
+  }
+
+  std::uint32_t u32() {
+    const std::uint64_t v = varint();
+    if (v > UINT32_MAX) {
+      throw std::runtime_error("Belief delta value out of range");
+    }
+    return static_cast<std::uint32_t>(v);
+  }
+
+  std::uint64_t fixed64() {
+    need(8);
+    std::uint64_t u = 0;
+    for (int i = 0; i < 8; ++i) u |= static_cast<std::uint64_t>(*p_++) << (8 * i);
+    return u;
+  }
+
+  double f64() {
+    const std::uint64_t u = fixed64();
+    double d;
+    std::memcpy(&d, &u, sizeof d);
+    return d;
+  }
+
+  std::string str() {
+    const std::size_t n = count();
+    need(n);
+    std::string s(reinterpret_cast<const char*>(p_), n);
+    p_ += n;
+    return s;
+  }
+
+  std::vector<WorldId> ids() {
+    std::vector<WorldId> v(count());
+    WorldId prev = 0;
+    for (auto& id : v) {
+      id = prev + varint();
+      prev = id;
+    }
+    return v;
+  }
+
+  // Element count, bounded by the bytes left (each element >= 1 byte)
+  std::size_t count() {
+    const std::uint64_t n = varint();
+    if (n > static_cast<std::uint64_t>(end_ - p_)) {
+      throw std::runtime_error("Belief delta count exceeds message size");
+    }
+    return static_cast<std::size_t>(n);
+  }
+
+  bool done() const { return p_ == end_; }
+
+private:
+  void need(std::size_t n) {
+    if (static_cast<std::size_t>(end_ - p_) < n) {
+      throw std::runtime_error("Truncated belief delta");
+    }
+  }
+
+  const std::uint8_t* p_;
+  const std::uint8_t* end_;
+};
+
+void write_world(Writer& out, const WorldDelta& d) {
+  out.varint(d.id);
+  out.u8(d.has_parent ? 1 : 0);
+  if (d.has_parent) out.varint(d.parent);
+
+  out.varint(d.width);
+  out.varint(d.height);
+  out.f64(d.resolution);
+
+  out.varint(d.cells.size());
+  std::uint32_t prev_end = 0;
+  for (const CellRun& run : d.cells) {
+    out.varint(run.start - prev_end); // runs are sorted and disjoint
+    out.varint(run.length);
+    out.u8(static_cast<std::uint8_t>(run.state));
+    prev_end = run.start + run.length;
+  }
+
+  out.varint(d.poses.size());
+  for (const auto& [agent, p] : d.poses) {
+    out.varint(agent);
+    out.f64(p.x);
+    out.f64(p.y);
+    out.f64(p.theta);
+  }
+
+  out.varint(d.goals.size());
+  for (const auto& [agent, g] : d.goals) {
+    out.varint(agent);
+    out.str(g);
+  }
+}
+
+// Charges the world's map area against the delta-wide budget.
+void charge_cells(std::uint64_t cells, std::uint64_t& total) {
+  if (cells > kMaxDeltaCells) {
+    throw std::runtime_error("Belief delta map too large");
+  }
+  total += cells;
+  if (total > kMaxDeltaTotalCells) {
+    throw std::runtime_error("Belief delta maps too large in total");
+  }
+}
+
+WorldDelta read_world(Reader& in, std::uint64_t& total_cells) {
+  WorldDelta d;
+  d.id = in.varint();
+  d.has_parent = in.u8() != 0;
+  if (d.has_parent) d.parent = in.varint();
+
+  d.width = in.u32();
+  d.height = in.u32();
+  d.resolution = in.f64();
+
+  const std::uint64_t n = static_cast<std::uint64_t>(d.width) * d.height;
+  charge_cells(n, total_cells);
+
+  d.cells.resize(in.count());
+  std::uint64_t prev_end = 0;
+  for (CellRun& run : d.cells) {
+    const std::uint64_t start = prev_end + in.varint();
+    const std::uint64_t length = in.varint();
+    if (start > n || length > n - start) {
+      throw std::runtime_error("Belief delta cell run out of bounds");
+    }
+    run.start = static_cast<std::uint32_t>(start);
+    run.length = static_cast<std::uint32_t>(length);
+    const std::uint8_t state = in.u8();
+    if (state > static_cast<std::uint8_t>(CellState::Occupied)) {
+      throw std::runtime_error("Invalid cell state in belief delta");
+    }
+    run.state = static_cast<CellState>(state);
+    prev_end = run.start + run.length;
+  }
+
+  d.poses.resize(in.count());
+  for (auto& [agent, p] : d.poses) {
+    agent = in.u32();
+    p.x = in.f64();
+    p.y = in.f64();
+    p.theta = in.f64();
+  }
+
+  d.goals.resize(in.count());
+  for (auto& [agent, g] : d.goals) {
+    agent = in.u32();
+    g = in.str();
+  }
+  return d;
+}
+
+void write_edges(Writer& out, const std::vector<EdgeChange>& edges) {
+  out.varint(edges.size());
+  for (const EdgeChange& e : edges) {
+    out.varint(e.agent);
+    out.varint(e.from);
+    out.varint(e.to);
+  }
+}
+
+std::vector<EdgeChange> read_edges(Reader& in) {
+  std::vector<EdgeChange> edges(in.count());
+  for (EdgeChange& e : edges) {
+    e.agent = in.u32();
+    if (e.agent >= kMaxDeltaAgents) {
+      throw std::runtime_error("Belief delta agent out of range");
+    }
+    e.from = in.varint();
+    e.to = in.varint();
+  }
+  return edges;
+}
+
+// apply_delta without checks or version bump.
+void patch(BeliefState& state, const BeliefDelta& delta) {
+  auto& worlds = state.model.worlds;
+
+  // Materialize against the old worlds before anything is removed.
+  std::unordered_map<WorldId, std::size_t> index;
+  for (std::size_t i = 0; i < worlds.size(); ++i) index.emplace(worlds[i].id, i);
+
+  auto parent_of = [&](const WorldDelta& d) -> const World* {
+    if (!d.has_parent) return nullptr;
+    auto it = index.find(d.parent);
+    return it == index.end() ? nullptr : &worlds[it->second];
+  };
+
+  // Hand-built deltas skip decode_delta, so the budget is enforced here
+  // as well, before anything is allocated.
+  std::uint64_t total_cells = 0;
+  for (const auto* list : {&delta.added, &delta.modified}) {
+    for (const WorldDelta& d : *list) {
+      charge_cells(static_cast<std::uint64_t>(d.width) * d.height, total_cells);
+    }
+  }
+
+  std::vector<World> added;
+  added.reserve(delta.added.size());
+  for (const WorldDelta& d : delta.added) {
+    added.push_back(materialize(d, parent_of(d)));
+  }
+
+  std::vector<World> modified;
+  modified.reserve(delta.modified.size());
+  for (const WorldDelta& d : delta.modified) {
+    modified.push_back(materialize(d, parent_of(d)));
+  }
+  for (World& w : modified) {
+    auto it = index.find(w.id);
+    if (it == index.end()) {
+      throw std::runtime_error("Belief delta modifies an unknown world");
+    }
+    worlds[it->second] = std::move(w);
+  }
+
+  const std::unordered_set<WorldId> removed(delta.removed.begin(), delta.removed.end());
+  worlds.erase(
+    std::remove_if(worlds.begin(), worlds.end(), [&](const World& w) {
+      return removed.count(w.id) != 0;
+    }),
+    worlds.end()
+  );
+  for (World& w : added) worlds.push_back(std::move(w));
+
+  // One pass per agent: a product update replaces every edge, so erasing
+  // removals one at a time would be quadratic.
+  auto& acc = state.model.accessibility;
+  std::vector<EdgeSet> drop(acc.size());
+  for (const EdgeChange& e : delta.edges_removed) {
+    if (e.agent < acc.size()) drop[e.agent].insert({e.from, e.to});
+  }
+  for (std::size_t a = 0; a < drop.size(); ++a) {
+    if (drop[a].empty()) continue;
+    auto& rel = acc[a];
+    rel.erase(
+      std::remove_if(rel.begin(), rel.end(), [&](const auto& edge) {
+        return drop[a].count(edge) != 0;
+      }),
+      rel.end()
+    );
+  }
+  for (const EdgeChange& e : delta.edges_added) {
+    if (e.agent >= acc.size()) acc.resize(e.agent + 1);
+    acc[e.agent].push_back({e.from, e.to});
+  }
+
+  const std::unordered_set<WorldId> undesignated(
+    delta.designated_removed.begin(), delta.designated_removed.end()
+  );
+  auto& designated = state.designated;
+  designated.erase(
+    std::remove_if(designated.begin(), designated.end(), [&](WorldId w) {
+      return undesignated.count(w) != 0;
+    }),
+    designated.end()
+  );
+  designated.insert(
+    designated.end(),
+    delta.designated_added.begin(),
+    delta.designated_added.end()
+  );
+}
+
+} // namespace
+
+BeliefDelta diff_beliefs(
+  const BeliefState& from,
+  const BeliefState& to
+) {
+  BeliefDelta delta;
+  delta.base = belief_digest(from);
+  delta.target = belief_digest(to);
+
+  std::unordered_map<WorldId, const World*> old_worlds;
+  for (const World& w : from.model.worlds) old_worlds.emplace(w.id, &w);
+
+  std::unordered_set<WorldId> new_ids;
+  for (const World& w : to.model.worlds) {
+    new_ids.insert(w.id);
+
+    auto same = old_worlds.find(w.id);
+    if (same != old_worlds.end()) {
+      if (!same_content(*same->second, w)) {
+        delta.modified.push_back(make_world_delta(w, same->second));
+      }
+      continue;
+    }
+
+    // Product worlds (w,e) carry w in the upper 32 bits.
+    auto parent = old_worlds.find(w.id >> 32);
+    delta.added.push_back(make_world_delta(
+      w, parent != old_worlds.end() ? parent->second : nullptr
+    ));
+  }
+
+  for (const World& w : from.model.worlds) {
+    if (!new_ids.count(w.id)) delta.removed.push_back(w.id);
+  }
+
+  const auto& old_acc = from.model.accessibility;
+  const auto& new_acc = to.model.accessibility;
+  const std::size_t agents = std::max(old_acc.size(), new_acc.size());
+
+  for (Agent a = 0; a < agents; ++a) {
+    EdgeSet before;
+    EdgeSet after;
+    if (a < old_acc.size()) before.insert(old_acc[a].begin(), old_acc[a].end());
+    if (a < new_acc.size()) after.insert(new_acc[a].begin(), new_acc[a].end());
+
+    for (const auto& e : after) {
+      if (!before.count(e)) delta.edges_added.push_back({a, e.first, e.second});
+    }
+    for (const auto& e : before) {
+      if (!after.count(e)) delta.edges_removed.push_back({a, e.first, e.second});
+    }
+  }
+
+  const std::unordered_set<WorldId> old_d(from.designated.begin(), from.designated.end());
+  const std::unordered_set<WorldId> new_d(to.designated.begin(), to.designated.end());
+  for (WorldId w : new_d) {
+    if (!old_d.count(w)) delta.designated_added.push_back(w);
+  }
+  for (WorldId w : old_d) {
+    if (!new_d.count(w)) delta.designated_removed.push_back(w);
+  }
+
+  return delta;
+}
+
+void apply_delta(
+  BeliefState& state,
+  const BeliefDelta& delta,
+  bool verify
+) {
+  if (!verify) {
+    patch(state, delta);
+    state.touch();
+    return;
+  }
+
+  if (belief_digest(state) != delta.base) {
+    throw std::runtime_error("Belief delta does not apply to this state");
+  }
+
+  BeliefState next = state;
+  patch(next, delta);
+  if (belief_digest(next) != delta.target) {
+    throw std::runtime_error("Belief delta did not produce its target state");
+  }
+
+  state = std::move(next);
+  state.touch();
+}
+
+std::vector<std::uint8_t> encode_delta(const BeliefDelta& delta) {
+  Writer out;
+  for (std::uint8_t b : kMagic) out.u8(b);
+
+  out.fixed64(delta.base);
+  out.fixed64(delta.target);
+
+  out.varint(delta.added.size());
+  for (const WorldDelta& d : delta.added) write_world(out, d);
+
+  out.varint(delta.modified.size());
+  for (const WorldDelta& d : delta.modified) write_world(out, d);
+
+  out.ids(delta.removed);
+
+  write_edges(out, delta.edges_added);
+  write_edges(out, delta.edges_removed);
+
+  out.ids(delta.designated_added);
+  out.ids(delta.designated_removed);
+
+  return out.take();
+}
+
+BeliefDelta decode_delta(const std::uint8_t* data, std::size_t size) {
+  Reader in(data, size);
+  for (std::uint8_t b : kMagic) {
+    if (in.u8() != b) throw std::runtime_error("Not a belief delta");
+  }
+
+  BeliefDelta delta;
+  delta.base = in.fixed64();
+  delta.target = in.fixed64();
+
+  std::uint64_t total_cells = 0;
+  delta.added.resize(in.count());
+  for (WorldDelta& d : delta.added) d = read_world(in, total_cells);
+
+  delta.modified.resize(in.count());
+  for (WorldDelta& d : delta.modified) d = read_world(in, total_cells);
+
+  delta.removed = in.ids();
+
+  delta.edges_added = read_edges(in);
+  delta.edges_removed = read_edges(in);
+
+  delta.designated_added = in.ids();
+  delta.designated_removed = in.ids();
+
+  if (!in.done()) {
+    throw std::runtime_error("Trailing bytes after belief delta");
+  }
+  return delta;
+}
+
+} // namespace epistemic
@@ -0,0 +1,155 @@
+#include "epistemic/belief_store.hpp"
+#include "epistemic/fingerprint.hpp"
+#include "epistemic/quadtree_map.hpp"
+
+#include <stdexcept>
+#include <unordered_set>
+
+namespace epistemic {
+
+std::shared_ptr<const World> PersistentBeliefStore::intern(World&& w) {
+  const std::uint64_t h = world_content_hash(w);
+
+  auto [begin, end] = pool_.equal_range(h);
+  for (auto it = begin; it != end; ++it) {
+    auto stored = it->second.lock();
+    if (stored && *stored == w) return stored;
+  }
+
+  auto stored = std::make_shared<const World>(std::move(w));
+  pool_.emplace(h, stored);
+  return stored;
+}
+
+std::uint64_t PersistentBeliefStore::commit(BeliefState state) {
+  auto snapshot = std::make_shared<BeliefSnapshot>();
+  snapshot->revision = next_revision_++;
+  snapshot->parent = head_ ? head_->revision : 0;
+  snapshot->version = state.version;
+
+  std::vector<StoredWorld> worlds;
+  worlds.reserve(state.model.worlds.size());
+  for (World& w : state.model.worlds) {
+    const WorldId id = w.id;
+    worlds.push_back({id, intern(std::move(w))});
+  }
+  snapshot->worlds = ChunkedVector<StoredWorld>::build(worlds, &world_chunks_);
+
+  const auto& accessibility = state.model.accessibility;
+  snapshot->accessibility.reserve(accessibility.size());
+  for (const auto& rel : accessibility) {
+    snapshot->accessibility.push_back(
+      ChunkedVector<std::pair<WorldId, WorldId>>::build(rel, &edge_chunks_));
+  }
+
+  snapshot->designated = ChunkedVector<WorldId>::build(
+    state.designated, &designated_chunks_);
+
+  revisions_.push_back(snapshot);
+  head_ = std::move(snapshot);
+  trim();
+
+  return head_->revision;
+}
+
+std::shared_ptr<const BeliefSnapshot> PersistentBeliefStore::snapshot(
+  std::uint64_t revision
+) const {
+  // Revisions are consecutive, so the deque is indexed by offset.
+  const std::uint64_t first = first_revision();
+  if (revisions_.empty() || revision < first ||
+      revision - first >= revisions_.size()) {
+    return nullptr;
+  }
+  return revisions_[revision - first];
+}
+
+bool PersistentBeliefStore::rollback(std::uint64_t revision) {
+  auto target = snapshot(revision);
+  if (!target) return false;
+  head_ = std::move(target);
+  return true;
+}
+
+BeliefState PersistentBeliefStore::materialize(const BeliefSnapshot& snapshot) {
+  BeliefState state;
+  state.version = snapshot.version;
+
+  state.model.worlds.reserve(snapshot.worlds.size());
+  snapshot.worlds.for_each([&](const StoredWorld& slot) {
+    state.model.worlds.push_back(*slot.world);
+    state.model.worlds.back().id = slot.id;
+  });
+
+  state.model.accessibility.reserve(snapshot.accessibility.size());
+  for (const auto& rel : snapshot.accessibility) {
+    state.model.accessibility.push_back(rel.to_vector());
+  }
+
+  state.designated = snapshot.designated.to_vector();
+  return state;
+}
+
+BeliefState PersistentBeliefStore::materialize(std::uint64_t revision) const {
+  auto target = snapshot(revision);
+  if (!target) {
+    throw std::out_of_range("PersistentBeliefStore: unknown revision");
+  }
+  return materialize(*target);
+}
+
+void PersistentBeliefStore::trim() {
+  if (max_revisions_ == 0 || revisions_.size() <= max_revisions_) return;
+
+  // The head keeps its own snapshot alive even once trimmed.
+  while (revisions_.size() > max_revisions_) revisions_.pop_front();
+
+  for (auto it = pool_.begin(); it != pool_.end();) {
+    it = it->second.expired() ? pool_.erase(it) : std::next(it);
+  }
+
+  world_chunks_.prune();
+  edge_chunks_.prune();
+  designated_chunks_.prune();
+}
+
+BeliefStoreStats PersistentBeliefStore::stats() const {
+  BeliefStoreStats stats;
+  stats.revisions = revisions_.size();
+
+  std::unordered_set<const void*> seen;
+
+  auto count_chunks = [&](const auto& vec) {
+    using Chunk = typename std::decay_t<decltype(vec)>::Chunk;
+    for (const auto& chunk : vec.chunks()) {
+      if (!seen.insert(chunk.get()).second) continue;
+      ++stats.chunks;
+      stats.bytes += sizeof(Chunk) +
+        chunk->capacity() * sizeof(typename Chunk::value_type);
+    }
+  };
+
+  auto count = [&](const BeliefSnapshot& s) {
+    count_chunks(s.worlds);
+    for (const auto& rel : s.accessibility) count_chunks(rel);
+    count_chunks(s.designated);
+
+    s.worlds.for_each([&](const StoredWorld& slot) {
+      const World& w = *slot.world;
+      if (!seen.insert(&w).second) return;
+      ++stats.distinct_worlds;
+      stats.bytes += sizeof(World) +
+        w.map.cell_bytes() +
+        (w.sparse_map ? w.sparse_map->memory_bytes() : 0) +
+        w.poses.size() * sizeof(std::pair<const Agent, Pose>) +
+        w.goals.size() * sizeof(std::pair<const Agent, std::string>);
+    });
+  };
+
+  for (const auto& s : revisions_) count(*s);
+  if (head_) count(*head_);
+
+  return stats;
+}
+
+} // namespace epistemic
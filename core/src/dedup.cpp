@@ -0,0 +1,86 @@
+#include "epistemic/dedup.hpp"
+#include "epistemic/fingerprint.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace epistemic {
+
+BeliefState deduplicate_worlds(
+  const BeliefState& belief,
+  DedupMode mode,
+  DedupStats* stats
+) {
+  const auto& worlds = belief.model.worlds;
+
+  std::unordered_map<WorldId, Fingerprint> colors;
+  if (mode == DedupMode::Bisimulation) {
+    colors = bisimulation_colors(belief);
+  }
+
+  // Bucket by hash; confirm structurally inside the bucket.
+  std::unordered_map<std::uint64_t, std::vector<std::size_t>> buckets;
+  std::unordered_map<WorldId, WorldId> representative;
+
+  BeliefState out;
+
+  for (std::size_t i = 0; i < worlds.size(); ++i) {
+    const World& w = worlds[i];
+
+    std::uint64_t key = world_content_hash(w);
+    if (mode == DedupMode::Bisimulation) key ^= colors[w.id];
+
+    auto& bucket = buckets[key];
+    auto same = std::find_if(bucket.begin(), bucket.end(), [&](std::size_t j) {
+      return out.model.worlds[j] == w &&
+             (mode == DedupMode::Content ||
+              colors[out.model.worlds[j].id] == colors[w.id]);
+    });
+
+    if (same != bucket.end()) {
+      representative[w.id] = out.model.worlds[*same].id;
+      continue;
+    }
+
+    bucket.push_back(out.model.worlds.size());
+    representative[w.id] = w.id;
+    out.model.worlds.push_back(w);
+  }
+
+  auto redirect = [&](WorldId w) {
+    auto it = representative.find(w);
+    return it == representative.end() ? w : it->second;
+  };
+
+  const auto& accessibility = belief.model.accessibility;
+  out.model.accessibility.resize(accessibility.size());
+
+  for (Agent a = 0; a < accessibility.size(); ++a) {
+    auto& rel = out.model.accessibility[a];
+    rel.reserve(accessibility[a].size());
+
+    for (const auto& [w1, w2] : accessibility[a]) {
+      rel.push_back({redirect(w1), redirect(w2)});
+    }
+
+    std::sort(rel.begin(), rel.end());
+    rel.erase(std::unique(rel.begin(), rel.end()), rel.end());
+  }
+
+  std::unordered_set<WorldId> seen;
+  for (WorldId w : belief.designated) {
+    const WorldId r = redirect(w);
+    if (seen.insert(r).second) out.designated.push_back(r);
+  }
+
+  if (stats) {
+    stats->worlds_before = worlds.size();
+    stats->worlds_after = out.model.worlds.size();
+  }
+
+  return out;
+}
+
+} // namespace epistemic
@@ -1,18 +1,31 @@
 #include "epistemic/del_update.hpp"
 #include "epistemic/query.hpp"
 
+#include <unordered_map>
+#include <unordered_set>
+
 namespace epistemic {
 
 BeliefState product_update(
   const BeliefState& belief,
   const EventModel& event_model
 ) {
+  return product_update(belief, event_model,
+    [&](WorldId w, const Event& e) { return holds(belief, w, e.precondition); });
+}
+
+BeliefState product_update(
+  const BeliefState& belief,
+  const EventModel& event_model,
+  const std::function<bool(WorldId, const Event&)>& pre
+) {
+  // Gets a fresh version, so QueryCache entries for `belief` are dropped.
   BeliefState updated;
 
   // Create new worlds (w,e)
   for (WorldId w_id : belief.designated) {
     for (const Event& e : event_model.events) {
-      if (holds(belief, w_id, e.precondition)) {
+      if (pre(w_id, e)) {
         World new_world = *std::find_if(
           belief.model.worlds.begin(),
           belief.model.worlds.end(),
@@ -30,16 +43,19 @@ BeliefState product_update(
   }
 
   // Update accessibility
-  for (const auto& [agent, rel] : belief.model.accessibility) {
-    for (const auto& [w1, w2] : rel) {
+  const auto& accessibility = belief.model.accessibility;
+  updated.model.accessibility.resize(accessibility.size());
+
+  for (Agent agent = 0; agent < accessibility.size(); ++agent) {
+    for (const auto& [w1, w2] : accessibility[agent]) {
       for (const Event& e1 : event_model.events) {
         for (const Event& e2 : event_model.events) {
 
           if (!event_model.accessible(agent, e1.id, e2.id))
             continue;
 
-          if (!holds(belief, w1, e1.precondition)) continue;
-          if (!holds(belief, w2, e2.precondition)) continue;
+          if (!pre(w1, e1)) continue;
+          if (!pre(w2, e2)) continue;
 
           WorldId new_w1 =
             (static_cast<WorldId>(w1) << 32) |
@@ -60,4 +76,69 @@ BeliefState product_update(
   return updated;
 }
 
+void renumber_worlds(BeliefState& belief) {
+  std::unordered_map<WorldId, WorldId> ids;
+  ids.reserve(belief.model.worlds.size());
+  for (World& w : belief.model.worlds) {
+    const WorldId id = ids.size();
+    ids.emplace(w.id, id);
+    w.id = id;
+  }
+
+  auto remap = [&](WorldId& w) {
+    auto it = ids.find(w);
+    if (it == ids.end()) return false;
+    w = it->second;
+    return true;
+  };
+
+  auto& designated = belief.designated;
+  designated.erase(
+    std::remove_if(designated.begin(), designated.end(),
+      [&](WorldId& w) { return !remap(w); }),
+    designated.end());
+
+  for (auto& rel : belief.model.accessibility) {
+    rel.erase(
+      std::remove_if(rel.begin(), rel.end(),
+        [&](auto& e) { return !remap(e.first) || !remap(e.second); }),
+      rel.end());
+  }
+  belief.touch();
+}
+
+BeliefState public_announcement(
+  const BeliefState& belief,
+  const Formula& phi
+) {
+  BeliefState updated;
+
+  std::unordered_set<WorldId> kept;
+  for (WorldId w_id : belief.designated) {
+    if (holds(belief, w_id, phi)) {
+      kept.insert(w_id);
+      updated.designated.push_back(w_id);
+    }
+  }
+
+  for (const World& w : belief.model.worlds) {
+    if (kept.count(w.id)) {
+      updated.model.worlds.push_back(w);
+    }
+  }
+
+  const auto& accessibility = belief.model.accessibility;
+  updated.model.accessibility.resize(accessibility.size());
+
+  for (Agent agent = 0; agent < accessibility.size(); ++agent) {
+    for (const auto& [w1, w2] : accessibility[agent]) {
+      if (kept.count(w1) && kept.count(w2)) {
+        updated.model.accessibility[agent].push_back({w1, w2});
+      }
+    }
+  }
+
+  return updated;
+}
+
 } // namespace epistemic
@@ -0,0 +1,256 @@
+#include "epistemic/world.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+namespace epistemic {
+
+namespace {
+
+constexpr float kInf = std::numeric_limits<float>::infinity();
+
+/**
+ * Brushfire over a distance field: every cell remembers its nearest
+ * occupied cell and offers it to its 8 neighbours, closest first.
+ * Seeding only the changed cells gives the incremental update.
+ */
+class Brushfire {
+public:
+  Brushfire(DistanceField& field, const GridMap& map)
+    : f_(field), map_(map) {}
+
+  void seed(std::int32_t site) {
+    f_.distance[site] = 0.0f;
+    f_.nearest[site] = site;
+    open_.push({0.0f, site});
+  }
+
+  /**
+   * Clear the cells whose nearest site is no longer occupied, starting
+   * from the removed sites, and queue the surviving border so lower()
+   * refills the hole.
+   */
+  void raise(std::vector<std::int32_t> removed) {
+    for (std::int32_t c : removed) reset(c);
+
+    while (!removed.empty()) {
+      const std::int32_t c = removed.back();
+      removed.pop_back();
+
+      neighbours(c, [&](std::int32_t n) {
+        const std::int32_t site = f_.nearest[n];
+        if (site < 0) return;
+
+        if (map_.cells()[site] != CellState::Occupied) {
+          reset(n);
+          removed.push_back(n);
+        } else {
+          open_.push({f_.distance[n], n});
+        }
+      });
+    }
+  }
+
+  void lower() {
+    while (!open_.empty()) {
+      const auto [d, c] = open_.top();
+      open_.pop();
+
+      const std::int32_t site = f_.nearest[c];
+      if (site < 0 || d > f_.distance[c]) continue;
+
+      neighbours(c, [&](std::int32_t n) {
+        const float nd = distance(n, site);
+        if (nd < f_.distance[n]) {
+          f_.distance[n] = nd;
+          f_.nearest[n] = site;
+          open_.push({nd, n});
+        }
+      });
+    }
+  }
+
+private:
+  using Entry = std::pair<float, std::int32_t>;
+
+  void reset(std::int32_t c) {
+    f_.distance[c] = kInf;
+    f_.nearest[c] = -1;
+  }
+
+  float distance(std::int32_t a, std::int32_t b) const {
+    const std::int32_t w = static_cast<std::int32_t>(f_.width);
+    const float dx = static_cast<float>(a % w - b % w);
+    const float dy = static_cast<float>(a / w - b / w);
+    return std::sqrt(dx * dx + dy * dy) * static_cast<float>(f_.resolution);
+  }
+
+  template <typename F>
+  void neighbours(std::int32_t c, F&& visit) const {
+    const std::int32_t w = static_cast<std::int32_t>(f_.width);
+    const std::int32_t h = static_cast<std::int32_t>(f_.height);
+    const std::int32_t x = c % w;
+    const std::int32_t y = c / w;
+
+    for (std::int32_t dy = -1; dy <= 1; ++dy) {
+      for (std::int32_t dx = -1; dx <= 1; ++dx) {
+        const std::int32_t nx = x + dx;
+        const std::int32_t ny = y + dy;
+        if ((dx || dy) && nx >= 0 && ny >= 0 && nx < w && ny < h) {
+          visit(ny * w + nx);
+        }
+      }
+    }
+  }
+
+  DistanceField& f_;
+  const GridMap& map_;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open_;
+};
+
+std::shared_ptr<const DistanceField> build_field(const GridMap& map) {
+  auto field = std::make_shared<DistanceField>();
+  field->width = map.width;
+  field->height = map.height;
+  field->resolution = map.resolution;
+  field->distance.assign(map.cells().size(), kInf);
+  field->nearest.assign(map.cells().size(), -1);
+
+  Brushfire fire(*field, map);
+  for (std::size_t i = 0; i < map.cells().size(); ++i) {
+    if (map.cells()[i] == CellState::Occupied) {
+      fire.seed(static_cast<std::int32_t>(i));
+    }
+  }
+  fire.lower();
+
+  return field;
+}
+
+std::shared_ptr<const DistanceField> patch_field(
+  const DistanceField& previous,
+  const GridMap& map,
+  const std::uint32_t* first,
+  const std::uint32_t* last
+) {
+  auto field = std::make_shared<DistanceField>(previous);
+  Brushfire fire(*field, map);
+
+  std::vector<std::int32_t> removed;
+  for (; first != last; ++first) {
+    const auto c = static_cast<std::int32_t>(*first);
+    const bool occupied = map.cells()[c] == CellState::Occupied;
+    const bool was = field->nearest[c] == c;
+
+    if (occupied && !was) {
+      fire.seed(c);
+    } else if (!occupied && was) {
+      removed.push_back(c);
+    }
+  }
+
+  fire.raise(std::move(removed));
+  fire.lower();
+  return field;
+}
+
+// ---- sharing between identical maps -------------------------------------
+
+std::uint64_t occupancy_hash(const GridMap& map) {
+  std::uint64_t h = 0xcbf29ce484222325ULL;
+  auto fold = [&](std::uint64_t v) { h = (h ^ v) * 0x100000001b3ULL; };
+
+  fold(map.width);
+  fold(map.height);
+  fold(static_cast<std::uint64_t>(map.resolution * 1e6));
+  for (CellState c : map.cells()) fold(c == CellState::Occupied);
+  return h;
+}
+
+bool matches(const DistanceField& f, const GridMap& map) {
+  if (f.width != map.width || f.height != map.height ||
+      f.resolution != map.resolution) {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < map.cells().size(); ++i) {
+    const bool site = f.nearest[i] == static_cast<std::int32_t>(i);
+    if (site != (map.cells()[i] == CellState::Occupied)) return false;
+  }
+  return true;
+}
+
+class FieldCache {
+public:
+  std::shared_ptr<const DistanceField> get(const GridMap& map) {
+    const std::uint64_t key = occupancy_hash(map);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = fields_.find(key);
+      if (it != fields_.end()) {
+        auto field = it->second.lock();
+        if (field && matches(*field, map)) return field;
+      }
+    }
+
+    // Build outside the lock; a racing builder just wins the slot.
+    auto field = build_field(map);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    fields_[key] = field;
+    if (fields_.size() > 2 * prune_at_) prune();
+    return field;
+  }
+
+private:
+  void prune() {
+    for (auto it = fields_.begin(); it != fields_.end();) {
+      it = it->second.expired() ? fields_.erase(it) : std::next(it);
+    }
+    prune_at_ = std::max<std::size_t>(fields_.size(), 64);
+  }
+
+  std::mutex mutex_;
+  std::unordered_map<std::uint64_t, std::weak_ptr<const DistanceField>> fields_;
+  std::size_t prune_at_ = 64;
+};
+
+FieldCache& field_cache() {
+  static FieldCache cache;
+  return cache;
+}
+
+} // namespace
+
+std::shared_ptr<const DistanceField> GridMap::distance_field() const {
+  auto slot = std::atomic_load(&field_);
+  if (slot && slot->revision == revision_) {
+    return slot->field;
+  }
+
+  std::shared_ptr<const DistanceField> field;
+
+  // The edit log covers everything since the cached revision.
+  if (slot && slot->revision >= edit_base_ &&
+      slot->field->width == width && slot->field->height == height) {
+    const std::uint32_t* log = edits_.data();
+    field = patch_field(
+      *slot->field, *this,
+      log + (slot->revision - edit_base_), log + edits_.size());
+  } else {
+    field = field_cache().get(*this);
+  }
+
+  std::atomic_store(
+    &field_, std::make_shared<const FieldSlot>(FieldSlot{revision_, field}));
+  return field;
+}
+
+} // namespace epistemic
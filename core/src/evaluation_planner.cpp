@@ -0,0 +1,422 @@
+#include "epistemic/evaluation_planner.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace epistemic {
+
+namespace {
+
+bool is_junction(FormulaType type) {
+    return type == FormulaType::AND || type == FormulaType::OR || type == FormulaType::IMPLIES;
+}
+
+std::size_t mix(std::size_t h, std::size_t v) {
+    return h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+/// Hash of a node given its children's hashes
+std::size_t node_hash(const Formula& phi, std::size_t left, std::size_t right) {
+    std::size_t h = mix(static_cast<std::size_t>(phi.get_type()), left);
+    h = mix(h, right);
+    
+    switch (phi.get_type()) {
+        case FormulaType::ATOM:
+            return mix(h, std::hash<std::string>{}(static_cast<const Atom&>(phi).get_proposition()));
+        case FormulaType::KNOWS:
+            return mix(h, static_cast<const Knows&>(phi).get_agent());
+        case FormulaType::COMMON_KNOWLEDGE:
+            return mix(h, static_cast<const CommonKnowledge&>(phi).get_group());
+        case FormulaType::EVERYBODY_KNOWS:
+            return mix(h, static_cast<const EverybodyKnows&>(phi).get_group());
+        case FormulaType::DISTRIBUTED_KNOWLEDGE:
+            return mix(h, static_cast<const DistributedKnowledge&>(phi).get_group());
+        default:
+            return h;
+    }
+}
+
+/**
+ * Calls f on the children of a node (none, one or two) and returns
+ * their results, 0 for a missing child.
+ */
+template <typename F>
+std::pair<std::size_t, std::size_t> visit_children(const Formula& phi, F&& f) {
+    switch (phi.get_type()) {
+        case FormulaType::NOT:
+            return {f(static_cast<const Not&>(phi).get_subformula()), 0};
+        case FormulaType::AND: {
+            const auto& g = static_cast<const And&>(phi);
+            return {f(g.get_left()), f(g.get_right())};
+        }
+        case FormulaType::OR: {
+            const auto& g = static_cast<const Or&>(phi);
+            return {f(g.get_left()), f(g.get_right())};
+        }
+        case FormulaType::IMPLIES: {
+            const auto& g = static_cast<const Implies&>(phi);
+            return {f(g.get_left()), f(g.get_right())};
+        }
+        case FormulaType::KNOWS:
+            return {f(static_cast<const Knows&>(phi).get_subformula()), 0};
+        case FormulaType::COMMON_KNOWLEDGE:
+            return {f(static_cast<const CommonKnowledge&>(phi).get_subformula()), 0};
+        case FormulaType::EVERYBODY_KNOWS:
+            return {f(static_cast<const EverybodyKnows&>(phi).get_subformula()), 0};
+        case FormulaType::DISTRIBUTED_KNOWLEDGE:
+            return {f(static_cast<const DistributedKnowledge&>(phi).get_subformula()), 0};
+        default:
+            return {0, 0};
+    }
+}
+
+std::size_t structural_hash(const Formula& phi) {
+    const auto [left, right] = visit_children(phi, structural_hash);
+    return node_hash(phi, left, right);
+}
+
+bool structurally_equal(const Formula& a, const Formula& b) {
+    if (&a == &b) return true;
+    if (a.get_type() != b.get_type()) return false;
+    
+    switch (a.get_type()) {
+        case FormulaType::TOP:
+        case FormulaType::BOTTOM:
+            return true;
+        case FormulaType::ATOM:
+            return static_cast<const Atom&>(a).get_proposition() ==
+                   static_cast<const Atom&>(b).get_proposition();
+        case FormulaType::NOT:
+            return structurally_equal(static_cast<const Not&>(a).get_subformula(),
+                                      static_cast<const Not&>(b).get_subformula());
+        case FormulaType::AND: {
+            const auto& x = static_cast<const And&>(a);
+            const auto& y = static_cast<const And&>(b);
+            return structurally_equal(x.get_left(), y.get_left()) &&
+                   structurally_equal(x.get_right(), y.get_right());
+        }
+        case FormulaType::OR: {
+            const auto& x = static_cast<const Or&>(a);
+            const auto& y = static_cast<const Or&>(b);
+            return structurally_equal(x.get_left(), y.get_left()) &&
+                   structurally_equal(x.get_right(), y.get_right());
+        }
+        case FormulaType::IMPLIES: {
+            const auto& x = static_cast<const Implies&>(a);
+            const auto& y = static_cast<const Implies&>(b);
+            return structurally_equal(x.get_left(), y.get_left()) &&
+                   structurally_equal(x.get_right(), y.get_right());
+        }
+        case FormulaType::KNOWS: {
+            const auto& x = static_cast<const Knows&>(a);
+            const auto& y = static_cast<const Knows&>(b);
+            return x.get_agent() == y.get_agent() &&
+                   structurally_equal(x.get_subformula(), y.get_subformula());
+        }
+        case FormulaType::COMMON_KNOWLEDGE: {
+            const auto& x = static_cast<const CommonKnowledge&>(a);
+            const auto& y = static_cast<const CommonKnowledge&>(b);
+            return x.get_group() == y.get_group() &&
+                   structurally_equal(x.get_subformula(), y.get_subformula());
+        }
+        case FormulaType::EVERYBODY_KNOWS: {
+            const auto& x = static_cast<const EverybodyKnows&>(a);
+            const auto& y = static_cast<const EverybodyKnows&>(b);
+            return x.get_group() == y.get_group() &&
+                   structurally_equal(x.get_subformula(), y.get_subformula());
+        }
+        case FormulaType::DISTRIBUTED_KNOWLEDGE: {
+            const auto& x = static_cast<const DistributedKnowledge&>(a);
+            const auto& y = static_cast<const DistributedKnowledge&>(b);
+            return x.get_group() == y.get_group() &&
+                   structurally_equal(x.get_subformula(), y.get_subformula());
+        }
+    }
+    return false;
+}
+
+/// Average number of successors per world for an agent
+double mean_degree(const KripkeModel& model, Agent agent) {
+    const std::size_t worlds = std::max<std::size_t>(model.get_worlds().size(), 1);
+    return static_cast<double>(model.relation_size(agent)) / worlds;
+}
+
+} // namespace
+
+EvaluationPlanner::EvaluationPlanner(std::size_t reorder_interval, std::size_t min_samples)
+    : reorder_interval_(std::max<std::size_t>(reorder_interval, 1)),
+      min_samples_(min_samples) {}
+
+bool EvaluationPlanner::evaluate(const KripkeModel& model, const Formula& phi, const std::string& world) {
+    return eval(model, own(phi), world);
+}
+
+const Formula& EvaluationPlanner::own(const Formula& phi) {
+    const std::size_t h = structural_hash(phi);
+    auto range = goal_index_.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (structurally_equal(*it->second, phi)) return *it->second;
+    }
+    
+    goals_.push_back(phi.clone());
+    const Formula& copy = *goals_.back();
+    index_nodes(copy);
+    goal_index_.emplace(h, &copy);
+    return copy;
+}
+
+std::size_t EvaluationPlanner::index_nodes(const Formula& phi) {
+    const auto [left, right] = visit_children(phi, [this](const Formula& child) {
+        return index_nodes(child);
+    });
+    const std::size_t h = node_hash(phi, left, right);
+    
+    auto range = node_index_.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (structurally_equal(*it->second, phi)) {
+            stats_[&phi] = stats_.at(it->second);
+            return h;
+        }
+    }
+    
+    node_index_.emplace(h, &phi);
+    stats_pool_.emplace_back();
+    stats_[&phi] = &stats_pool_.back();
+    return h;
+}
+
+const SubformulaStats* EvaluationPlanner::stats(const Formula& phi) const {
+    auto range = node_index_.equal_range(structural_hash(phi));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (!structurally_equal(*it->second, phi)) continue;
+        
+        const SubformulaStats* s = stats_.at(it->second);
+        return s->evaluations ? s : nullptr;
+    }
+    return nullptr;
+}
+
+void EvaluationPlanner::reset() {
+    stats_.clear();
+    stats_pool_.clear();
+    chains_.clear();
+    node_index_.clear();
+    goal_index_.clear();
+    goals_.clear();
+    visits_ = 0;
+}
+
+double EvaluationPlanner::estimate_cost(const KripkeModel& model, const Formula& phi) {
+    switch (phi.get_type()) {
+        case FormulaType::TOP:
+        case FormulaType::BOTTOM:
+        case FormulaType::ATOM:
+            return 1.0;
+        case FormulaType::NOT:
+            return 1.0 + estimate_cost(model, static_cast<const Not&>(phi).get_subformula());
+        case FormulaType::AND: {
+            const auto& f = static_cast<const And&>(phi);
+            return 1.0 + estimate_cost(model, f.get_left()) + estimate_cost(model, f.get_right());
+        }
+        case FormulaType::OR: {
+            const auto& f = static_cast<const Or&>(phi);
+            return 1.0 + estimate_cost(model, f.get_left()) + estimate_cost(model, f.get_right());
+        }
+        case FormulaType::IMPLIES: {
+            const auto& f = static_cast<const Implies&>(phi);
+            return 1.0 + estimate_cost(model, f.get_left()) + estimate_cost(model, f.get_right());
+        }
+        case FormulaType::KNOWS: {
+            const auto& f = static_cast<const Knows&>(phi);
+            const double degree = mean_degree(model, f.get_agent());
+            return 1.0 + degree * estimate_cost(model, f.get_subformula());
+        }
+        case FormulaType::EVERYBODY_KNOWS: {
+            const auto& f = static_cast<const EverybodyKnows&>(phi);
+            double degree = 0.0;
+            for_each_agent(f.get_group(), [&](Agent a) { degree += mean_degree(model, a); });
+            return 1.0 + degree * estimate_cost(model, f.get_subformula());
+        }
+        case FormulaType::DISTRIBUTED_KNOWLEDGE: {
+            // The intersection is at most the sparsest relation
+            const auto& f = static_cast<const DistributedKnowledge&>(phi);
+            double degree = f.get_group() ? static_cast<double>(model.get_worlds().size()) : 0.0;
+            for_each_agent(f.get_group(), [&](Agent a) { degree = std::min(degree, mean_degree(model, a)); });
+            return 1.0 + degree * estimate_cost(model, f.get_subformula());
+        }
+        case FormulaType::COMMON_KNOWLEDGE: {
+            // Reachability can cover the whole model
+            const auto& f = static_cast<const CommonKnowledge&>(phi);
+            const double worlds = static_cast<double>(model.get_worlds().size());
+            return 1.0 + worlds * (1.0 + estimate_cost(model, f.get_subformula()));
+        }
+    }
+    return 1.0;
+}
+
+bool EvaluationPlanner::eval(const KripkeModel& model, const Formula& phi, const std::string& world) {
+    const std::size_t before = visits_;
+    const bool value = eval_node(model, phi, world);
+    
+    SubformulaStats& s = *stats_.at(&phi);
+    ++s.evaluations;
+    s.true_count += value;
+    s.visits += visits_ - before;
+    return value;
+}
+
+bool EvaluationPlanner::eval_node(const KripkeModel& model, const Formula& phi, const std::string& world) {
+    ++visits_;
+    
+    switch (phi.get_type()) {
+        case FormulaType::TOP:
+            return true;
+        case FormulaType::BOTTOM:
+            return false;
+        case FormulaType::ATOM:
+            return phi.evaluate(model, world);
+        case FormulaType::NOT:
+            return !eval(model, static_cast<const Not&>(phi).get_subformula(), world);
+        case FormulaType::AND:
+        case FormulaType::OR:
+        case FormulaType::IMPLIES:
+            return eval_chain(model, phi, world);
+        
+        case FormulaType::KNOWS: {
+            const auto& f = static_cast<const Knows&>(phi);
+            const auto* accessible = model.successors(f.get_agent(), world);
+            if (accessible == nullptr) {
+                return true;  // No accessibility relation means vacuously true
+            }
+            for (const auto& w : *accessible) {
+                if (!eval(model, f.get_subformula(), w)) return false;
+            }
+            return true;
+        }
+        
+        case FormulaType::EVERYBODY_KNOWS: {
+            const auto& f = static_cast<const EverybodyKnows&>(phi);
+            for (AgentMask rest = f.get_group(); rest != 0; rest &= rest - 1) {
+                const auto* accessible = model.successors(lowest_agent(rest), world);
+                if (accessible == nullptr) continue;
+                for (const auto& w : *accessible) {
+                    if (!eval(model, f.get_subformula(), w)) return false;
+                }
+            }
+            return true;
+        }
+        
+        case FormulaType::DISTRIBUTED_KNOWLEDGE:
+            // Bitset intersection lives in the model; the body is not reordered
+            return phi.evaluate(model, world);
+        
+        case FormulaType::COMMON_KNOWLEDGE: {
+            const auto& f = static_cast<const CommonKnowledge&>(phi);
+            for (const auto& w : model.get_group_reachable_worlds(world, f.get_group())) {
+                if (!eval(model, f.get_subformula(), w)) return false;
+            }
+            return true;
+        }
+    }
+    
+    return phi.evaluate(model, world);
+}
+
+bool EvaluationPlanner::eval_chain(const KripkeModel& model, const Formula& phi, const std::string& world) {
+    Chain& chain = chain_for(phi);
+    
+    if (chain.evaluations++ % reorder_interval_ == 0) {
+        reorder(model, chain);
+    }
+    
+    // ∧ stops at the first false operand, ∨ at the first true one
+    for (const Operand& operand : chain.operands) {
+        const bool value = eval(model, *operand.formula, world) != operand.negated;
+        if (value != chain.conjunction) {
+            return value;
+        }
+    }
+    return chain.conjunction;
+}
+
+EvaluationPlanner::Chain& EvaluationPlanner::chain_for(const Formula& phi) {
+    auto it = chains_.find(&phi);
+    if (it != chains_.end()) {
+        return it->second;
+    }
+    
+    Chain chain;
+    chain.conjunction = phi.get_type() == FormulaType::AND;
+    
+    // Flatten the chain: φ → ψ is ¬φ ∨ ψ and joins an enclosing ∨
+    std::vector<Operand> stack{{&phi, false}};
+    
+    while (!stack.empty()) {
+        const Operand top = stack.back();
+        stack.pop_back();
+        
+        const FormulaType type = top.formula->get_type();
+        const bool same = !top.negated && is_junction(type) &&
+            (chain.conjunction ? type == FormulaType::AND : type != FormulaType::AND);
+        
+        if (!same) {
+            chain.operands.push_back(top);
+            continue;
+        }
+        
+        // Pushed right first so operands keep their written order
+        if (type == FormulaType::AND) {
+            const auto& f = static_cast<const And&>(*top.formula);
+            stack.push_back({&f.get_right(), false});
+            stack.push_back({&f.get_left(), false});
+        } else if (type == FormulaType::OR) {
+            const auto& f = static_cast<const Or&>(*top.formula);
+            stack.push_back({&f.get_right(), false});
+            stack.push_back({&f.get_left(), false});
+        } else {
+            const auto& f = static_cast<const Implies&>(*top.formula);
+            stack.push_back({&f.get_right(), false});
+            stack.push_back({&f.get_left(), true});
+        }
+    }
+    return chains_.emplace(&phi, std::move(chain)).first->second;
+}
+
+void EvaluationPlanner::reorder(const KripkeModel& model, Chain& chain) const {
+    const std::size_t n = chain.operands.size();
+    std::vector<double> rank(n);
+    
+    for (std::size_t i = 0; i < n; ++i) {
+        const Operand& operand = chain.operands[i];
+        
+        double cost = estimate_cost(model, *operand.formula);
+        double p_true = 0.5;
+        
+        const SubformulaStats& s = *stats_.at(operand.formula);
+        if (s.evaluations >= min_samples_) {
+            cost = std::max(s.mean_cost(), 1.0);
+            p_true = s.truth_rate();
+        }
+        if (operand.negated) {
+            p_true = 1.0 - p_true;
+        }
+        
+        // Probability this operand decides the chain on its own
+        const double p_stop = chain.conjunction ? 1.0 - p_true : p_true;
+        rank[i] = cost / std::max(p_stop, 1e-3);
+    }
+    
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return rank[a] < rank[b];
+    });
+    
+    std::vector<Operand> operands;
+    for (std::size_t i : order) {
+        operands.push_back(chain.operands[i]);
+    }
+    chain.operands.swap(operands);
+}
+
+} // namespace epistemic
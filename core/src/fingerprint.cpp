@@ -0,0 +1,180 @@
+#include "epistemic/fingerprint.hpp"
+#include "epistemic/quadtree_map.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace epistemic {
+
+namespace {
+
+std::uint64_t mix(std::uint64_t h, std::uint64_t v) {
+  // splitmix64 finalizer over the combined value
+  std::uint64_t z = h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+std::uint64_t bits(double d) {
+  std::uint64_t u;
+  std::memcpy(&u, &d, sizeof u);
+  return u;
+}
+
+std::uint64_t hash_sorted(std::vector<std::uint64_t>& v) {
+  std::sort(v.begin(), v.end());
+  v.erase(std::unique(v.begin(), v.end()), v.end());
+
+  std::uint64_t h = v.size();
+  for (std::uint64_t x : v) h = mix(h, x);
+  return h;
+}
+
+} // namespace
+
+std::uint64_t world_content_hash(const World& w) {
+  const std::uint64_t map = w.sparse_map ? w.sparse_map->hash() : w.map.hash();
+  std::uint64_t h = mix(map, bits(w.map.resolution));
+
+  // Order-independent over the unordered maps
+  std::uint64_t poses = 0;
+  for (const auto& [agent, p] : w.poses) {
+    poses += mix(mix(mix(agent, bits(p.x)), bits(p.y)), bits(p.theta));
+  }
+  h = mix(h, poses);
+
+  std::uint64_t goals = 0;
+  for (const auto& [agent, g] : w.goals) {
+    goals += mix(agent, std::hash<std::string>{}(g));
+  }
+  return mix(h, goals);
+}
+
+Fingerprint belief_digest(const BeliefState& belief) {
+  std::vector<std::uint64_t> items;
+  items.reserve(belief.model.worlds.size());
+  for (const World& w : belief.model.worlds) {
+    items.push_back(mix(w.id, world_content_hash(w)));
+  }
+  std::uint64_t h = hash_sorted(items);
+
+  const auto& accessibility = belief.model.accessibility;
+  for (Agent a = 0; a < accessibility.size(); ++a) {
+    if (accessibility[a].empty()) continue;
+
+    items.clear();
+    for (const auto& [from, to] : accessibility[a]) {
+      items.push_back(mix(from, to));
+    }
+    h = mix(mix(h, a), hash_sorted(items));
+  }
+
+  items.assign(belief.designated.begin(), belief.designated.end());
+  return mix(h, hash_sorted(items));
+}
+
+namespace {
+
+/**
+ * Coarsest stable colouring of the given worlds, restricted to the
+ * edges among them, in the order of `domain`.
+ */
+std::vector<std::uint64_t> refine_colors(
+  const BeliefState& belief,
+  const std::vector<WorldId>& domain
+) {
+  std::unordered_map<WorldId, std::size_t> index;
+  for (WorldId w : domain) {
+    index.emplace(w, index.size());
+  }
+  const std::size_t n = index.size();
+
+  std::vector<std::uint64_t> color(n, 0);
+  for (const World& w : belief.model.worlds) {
+    auto it = index.find(w.id);
+    if (it != index.end()) color[it->second] = world_content_hash(w);
+  }
+
+  // Successor lists per agent with a non-empty relation.
+  const auto& accessibility = belief.model.accessibility;
+
+  std::vector<Agent> agents;
+  for (Agent a = 0; a < accessibility.size(); ++a) {
+    if (!accessibility[a].empty()) agents.push_back(a);
+  }
+
+  std::vector<std::vector<std::vector<std::size_t>>> succ(agents.size());
+  for (std::size_t k = 0; k < agents.size(); ++k) {
+    succ[k].resize(n);
+    for (const auto& [w1, w2] : accessibility[agents[k]]) {
+      auto a = index.find(w1);
+      auto b = index.find(w2);
+      if (a == index.end() || b == index.end()) continue;
+      succ[k][a->second].push_back(b->second);
+    }
+  }
+
+  auto distinct = [](std::vector<std::uint64_t> v) {
+    std::sort(v.begin(), v.end());
+    return static_cast<std::size_t>(
+      std::unique(v.begin(), v.end()) - v.begin()
+    );
+  };
+
+  // Refine until the partition is stable. Bisimilar states realise the
+  // same colour sets every round, so they stop after the same round.
+  std::size_t classes = distinct(color);
+  std::vector<std::uint64_t> next(n);
+  std::vector<std::uint64_t> scratch;
+
+  for (std::size_t round = 0; round < n; ++round) {
+    for (std::size_t i = 0; i < n; ++i) {
+      std::uint64_t h = color[i];
+      for (std::size_t k = 0; k < agents.size(); ++k) {
+        if (succ[k][i].empty()) continue;
+
+        scratch.clear();
+        for (std::size_t j : succ[k][i]) scratch.push_back(color[j]);
+        h = mix(h, mix(agents[k], hash_sorted(scratch)));
+      }
+      next[i] = h;
+    }
+
+    color.swap(next);
+
+    const std::size_t refined = distinct(color);
+    if (refined == classes) break;
+    classes = refined;
+  }
+
+  return color;
+}
+
+} // namespace
+
+Fingerprint belief_fingerprint(const BeliefState& belief) {
+  // Only designated worlds are reachable by queries.
+  auto color = refine_colors(belief, belief.designated);
+  return hash_sorted(color);
+}
+
+std::unordered_map<WorldId, Fingerprint> bisimulation_colors(
+  const BeliefState& belief
+) {
+  std::vector<WorldId> domain;
+  domain.reserve(belief.model.worlds.size());
+  for (const World& w : belief.model.worlds) domain.push_back(w.id);
+
+  const auto color = refine_colors(belief, domain);
+
+  std::unordered_map<WorldId, Fingerprint> out;
+  for (std::size_t i = 0; i < domain.size(); ++i) {
+    out.emplace(domain[i], color[i]);
+  }
+  return out;
+}
+
+} // namespace epistemic
@@ -3,6 +3,27 @@
 
 namespace epistemic {
 
+static std::string group_to_string(AgentMask group) {
+    std::string group_str = "{";
+    bool first = true;
+    for_each_agent(group, [&](Agent agent) {
+        if (!first) group_str += ",";
+        group_str += std::to_string(agent);
+        first = false;
+    });
+    group_str += "}";
+    return group_str;
+}
+
+// Constants
+std::unique_ptr<Formula> Top::clone() const {
+    return std::make_unique<Top>();
+}
+
+std::unique_ptr<Formula> Bottom::clone() const {
+    return std::make_unique<Bottom>();
+}
+
 // Atom implementation
 Atom::Atom(const std::string& proposition) : proposition_(proposition) {}
 
@@ -79,7 +100,7 @@ std::unique_ptr<Formula> Implies::clone() const {
 }
 
 // Knows implementation
-Knows::Knows(const std::string& agent, std::unique_ptr<Formula> subformula)
+Knows::Knows(Agent agent, std::unique_ptr<Formula> subformula)
     : agent_(agent), subformula_(std::move(subformula)) {}
 
 bool Knows::evaluate(const KripkeModel& model, const std::string& world) const {
@@ -87,7 +108,7 @@ bool Knows::evaluate(const KripkeModel& model, const std::string& world) const {
 }
 
 std::string Knows::to_string() const {
-    return "K_" + agent_ + "(" + subformula_->to_string() + ")";
+    return "K_" + std::to_string(agent_) + "(" + subformula_->to_string() + ")";
 }
 
 std::unique_ptr<Formula> Knows::clone() const {
@@ -96,7 +117,7 @@ std::unique_ptr<Formula> Knows::clone() const {
 
 // CommonKnowledge implementation
 CommonKnowledge::CommonKnowledge(
-    const std::set<std::string>& group, 
+    AgentMask group, 
     std::unique_ptr<Formula> subformula)
     : group_(group), subformula_(std::move(subformula)) {}
 
@@ -105,15 +126,7 @@ bool CommonKnowledge::evaluate(const KripkeModel& model, const std::string& worl
 }
 
 std::string CommonKnowledge::to_string() const {
-    std::string group_str = "{";
-    bool first = true;
-    for (const auto& agent : group_) {
-        if (!first) group_str += ",";
-        group_str += agent;
-        first = false;
-    }
-    group_str += "}";
-    return "C_" + group_str + "(" + subformula_->to_string() + ")";
+    return "C_" + group_to_string(group_) + "(" + subformula_->to_string() + ")";
 }
 
 std::unique_ptr<Formula> CommonKnowledge::clone() const {
@@ -122,14 +135,14 @@ std::unique_ptr<Formula> CommonKnowledge::clone() const {
 
 // EverybodyKnows implementation
 EverybodyKnows::EverybodyKnows(
-    const std::set<std::string>& group,
+    AgentMask group,
     std::unique_ptr<Formula> subformula)
     : group_(group), subformula_(std::move(subformula)) {}
 
 bool EverybodyKnows::evaluate(const KripkeModel& model, const std::string& world) const {
     // E_G(φ) is true iff K_a(φ) is true for all a in G
-    for (const auto& agent : group_) {
-        if (!model.evaluate_knows(world, agent, *subformula_)) {
+    for (AgentMask rest = group_; rest != 0; rest &= rest - 1) {
+        if (!model.evaluate_knows(world, lowest_agent(rest), *subformula_)) {
             return false;
         }
     }
@@ -137,22 +150,40 @@ bool EverybodyKnows::evaluate(const KripkeModel& model, const std::string& world
 }
 
 std::string EverybodyKnows::to_string() const {
-    std::string group_str = "{";
-    bool first = true;
-    for (const auto& agent : group_) {
-        if (!first) group_str += ",";
-        group_str += agent;
-        first = false;
-    }
-    group_str += "}";
-    return "E_" + group_str + "(" + subformula_->to_string() + ")";
+    return "E_" + group_to_string(group_) + "(" + subformula_->to_string() + ")";
 }
 
 std::unique_ptr<Formula> EverybodyKnows::clone() const {
     return std::make_unique<EverybodyKnows>(group_, subformula_->clone());
 }
 
+// DistributedKnowledge implementation
+DistributedKnowledge::DistributedKnowledge(
+    AgentMask group,
+    std::unique_ptr<Formula> subformula)
+    : group_(group), subformula_(std::move(subformula)) {}
+
+bool DistributedKnowledge::evaluate(const KripkeModel& model, const std::string& world) const {
+    return model.evaluate_distributed_knowledge(world, group_, *subformula_);
+}
+
+std::string DistributedKnowledge::to_string() const {
+    return "D_" + group_to_string(group_) + "(" + subformula_->to_string() + ")";
+}
+
+std::unique_ptr<Formula> DistributedKnowledge::clone() const {
+    return std::make_unique<DistributedKnowledge>(group_, subformula_->clone());
+}
+
 // Helper functions
+std::unique_ptr<Formula> make_true() {
+    return std::make_unique<Top>();
+}
+
+std::unique_ptr<Formula> make_false() {
+    return std::make_unique<Bottom>();
+}
+
 std::unique_ptr<Formula> make_atom(const std::string& proposition) {
     return std::make_unique<Atom>(proposition);
 }
@@ -173,16 +204,27 @@ std::unique_ptr<Formula> make_implies(std::unique_ptr<Formula> left, std::unique
     return std::make_unique<Implies>(std::move(left), std::move(right));
 }
 
-std::unique_ptr<Formula> make_knows(const std::string& agent, std::unique_ptr<Formula> phi) {
+std::unique_ptr<Formula> make_knows(Agent agent, std::unique_ptr<Formula> phi) {
     return std::make_unique<Knows>(agent, std::move(phi));
 }
 
-std::unique_ptr<Formula> make_common_knowledge(const std::set<std::string>& group, std::unique_ptr<Formula> phi) {
+std::unique_ptr<Formula> make_knows(
+    const KripkeModel& model,
+    const std::string& agent,
+    std::unique_ptr<Formula> phi) {
+    return std::make_unique<Knows>(model.agent_index(agent), std::move(phi));
+}
+
+std::unique_ptr<Formula> make_common_knowledge(AgentMask group, std::unique_ptr<Formula> phi) {
     return std::make_unique<CommonKnowledge>(group, std::move(phi));
 }
 
-std::unique_ptr<Formula> make_everybody_knows(const std::set<std::string>& group, std::unique_ptr<Formula> phi) {
+std::unique_ptr<Formula> make_everybody_knows(AgentMask group, std::unique_ptr<Formula> phi) {
     return std::make_unique<EverybodyKnows>(group, std::move(phi));
 }
 
+std::unique_ptr<Formula> make_distributed_knowledge(AgentMask group, std::unique_ptr<Formula> phi) {
+    return std::make_unique<DistributedKnowledge>(group, std::move(phi));
+}
+
 } // namespace epistemic
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "epistemic/formula_parser.hpp"
+
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+
+namespace epistemic {
+
+namespace {
+
+/**
+ * Recursive descent over the grammar in formula_parser.hpp; & binds
+ * loosest and associates to the left.
+ */
+class FormulaParser {
+public:
+  explicit FormulaParser(const std::string& text) : text_(text) {}
+
+  Formula parse() {
+    Formula phi = conjunction();
+    finish();
+    return phi;
+  }
+
+  AgentMask parse_group() {
+    expect('[');
+    const AgentMask group = group_tail();
+    finish();
+    return group;
+  }
+
+private:
+  using Ptr = decltype(Not{}.phi);
+
+  static Ptr boxed(Formula phi) {
+    return Ptr(new Formula(std::move(phi)));
+  }
+
+  Formula conjunction() {
+    Formula phi = unary();
+    while (accept('&')) {
+      And both;
+      both.left = boxed(std::move(phi));
+      both.right = boxed(unary());
+      phi = Formula{std::move(both)};
+    }
+    return phi;
+  }
+
+  Formula unary() {
+    if (accept('!')) {
+      return Formula{Not{boxed(unary())}};
+    }
+    if (accept('(')) {
+      Formula phi = conjunction();
+      expect(')');
+      return phi;
+    }
+    if (accept_word("K[")) {
+      Knows knows;
+      knows.agent = agent();
+      expect(']');
+      knows.phi = boxed(unary());
+      return Formula{std::move(knows)};
+    }
+    if (accept_word("D[")) {
+      DistributedKnowledge dk;
+      dk.group = group_tail();
+      dk.phi = boxed(unary());
+      return Formula{std::move(dk)};
+    }
+    return Formula{Atom{atom()}};
+  }
+
+  std::string atom() {
+    skip_space();
+    const std::size_t start = pos_;
+    while (pos_ < text_.size() &&
+           (std::isalnum(static_cast<unsigned char>(text_[pos_])) ||
+            text_[pos_] == '_' || text_[pos_] == '.')) {
+      ++pos_;
+    }
+    if (pos_ == start) fail("expected an atom");
+
+    // Arguments are kept verbatim for interpret_atom
+    if (pos_ < text_.size() && text_[pos_] == '(') {
+      const std::size_t close = text_.find(')', pos_);
+      if (close == std::string::npos) fail("unterminated atom arguments");
+      pos_ = close + 1;
+    }
+    return text_.substr(start, pos_ - start);
+  }
+
+  // After the opening bracket.
+  AgentMask group_tail() {
+    AgentMask group = 0;
+    do {
+      group |= agent_bit(agent());
+    } while (accept(','));
+    expect(']');
+    return group;
+  }
+
+  Agent agent() {
+    skip_space();
+    const std::size_t start = pos_;
+    Agent a = 0;
+    while (pos_ < text_.size() &&
+           std::isdigit(static_cast<unsigned char>(text_[pos_]))) {
+      a = a * 10 + static_cast<Agent>(text_[pos_++] - '0');
+      if (a >= kMaxGroupAgents) fail("agent index out of range");
+    }
+    if (pos_ == start) fail("expected an agent index");
+    return a;
+  }
+
+  void skip_space() {
+    while (pos_ < text_.size() &&
+           std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+      ++pos_;
+    }
+  }
+
+  bool accept(char c) {
+    skip_space();
+    if (pos_ < text_.size() && text_[pos_] == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  bool accept_word(const char* word) {
+    skip_space();
+    const std::string w(word);
+    if (text_.compare(pos_, w.size(), w) != 0) return false;
+    pos_ += w.size();
+    return true;
+  }
+
+  void finish() {
+    skip_space();
+    if (pos_ != text_.size()) fail("unexpected input");
+  }
+
+  void expect(char c) {
+    if (!accept(c)) fail(std::string("expected '") + c + "'");
+  }
+
+  [[noreturn]] void fail(const std::string& what) const {
+    throw std::invalid_argument(
+      "Formula '" + text_ + "' at " + std::to_string(pos_) + ": " + what);
+  }
+
+  const std::string& text_;
+  std::size_t pos_ = 0;
+};
+
+} // namespace
+
+Formula parse_formula(const std::string& text) {
+  return FormulaParser(text).parse();
+}
+
+AgentMask parse_agent_group(const std::string& text) {
+  return FormulaParser(text).parse_group();
+}
+
+} // namespace epistemic
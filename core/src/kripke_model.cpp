@@ -10,8 +10,17 @@ KripkeModel::KripkeModel(const std::set<std::string>& agents)
     : agents_(agents), current_world_("w0") {
     worlds_.insert(current_world_);
     
+    if (agents_.size() > kMaxGroupAgents) {
+        throw std::runtime_error("Too many agents for AgentMask groups");
+    }
+    
     for (const auto& agent : agents_) {
-        accessibility_[agent][current_world_].insert(current_world_);
+        registry_.add(agent);
+    }
+    
+    accessibility_.resize(registry_.size());
+    for (auto& relation : accessibility_) {
+        relation[current_world_].insert(current_world_);
     }
 }
 
@@ -19,21 +28,66 @@ void KripkeModel::add_world(const std::string& world_id) {
     worlds_.insert(world_id);
 }
 
-void KripkeModel::remove_world(const std::string& world_id) {
+bool KripkeModel::remove_world(const std::string& world_id) {
     worlds_.erase(world_id);
     valuation_.erase(world_id);
     
-    for (auto& agent_pair : accessibility_) {
-        agent_pair.second.erase(world_id);
+    for (auto& relation : accessibility_) {
+        relation.erase(world_id);
         
-        for (auto& from_pair : agent_pair.second) {
+        for (auto& from_pair : relation) {
             from_pair.second.erase(world_id);
         }
     }
     
-    if (current_world_ == world_id && !worlds_.empty()) {
-        current_world_ = *worlds_.begin();
+    if (current_world_ != world_id) {
+        return false;
+    }
+    current_world_.clear();
+    return true;
+}
+
+bool KripkeModel::remove_dead_worlds(const std::unordered_set<std::string>& dead) {
+    if (dead.empty()) {
+        return false;
+    }
+    
+    for (const auto& world_id : dead) {
+        worlds_.erase(world_id);
+        valuation_.erase(world_id);
+    }
+    
+    for (auto& relation : accessibility_) {
+        for (auto from_it = relation.begin(); from_it != relation.end();) {
+            if (dead.count(from_it->first)) {
+                from_it = relation.erase(from_it);
+                continue;
+            }
+            
+            // Probe whichever side is smaller
+            auto& accessible = from_it->second;
+            if (accessible.size() <= dead.size()) {
+                for (auto to_it = accessible.begin(); to_it != accessible.end();) {
+                    if (dead.count(*to_it)) {
+                        to_it = accessible.erase(to_it);
+                    } else {
+                        ++to_it;
+                    }
+                }
+            } else {
+                for (const auto& world_id : dead) {
+                    accessible.erase(world_id);
+                }
+            }
+            ++from_it;
+        }
+    }
+    
+    if (!dead.count(current_world_)) {
+        return false;
     }
+    current_world_.clear();
+    return true;
 }
 
 void KripkeModel::add_accessibility_relation(
@@ -41,9 +95,7 @@ void KripkeModel::add_accessibility_relation(
     const std::string& from_world,
     const std::string& to_world) {
     
-    if (agents_.find(agent) == agents_.end()) {
-        throw std::runtime_error("Unknown agent: " + agent);
-    }
+    const Agent index = registry_.index(agent);
     
     if (worlds_.find(from_world) == worlds_.end()) {
         throw std::runtime_error("Unknown world: " + from_world);
@@ -53,7 +105,7 @@ void KripkeModel::add_accessibility_relation(
         throw std::runtime_error("Unknown world: " + to_world);
     }
     
-    accessibility_[agent][from_world].insert(to_world);
+    accessibility_[index][from_world].insert(to_world);
 }
 
 void KripkeModel::set_valuation(
@@ -92,28 +144,134 @@ bool KripkeModel::evaluate_atom(
     return get_valuation(world, atom);
 }
 
+const std::set<std::string>* KripkeModel::successors(
+    Agent agent,
+    const std::string& world) const {
+    
+    if (agent >= accessibility_.size()) {
+        return nullptr;
+    }
+    
+    auto world_it = accessibility_[agent].find(world);
+    if (world_it == accessibility_[agent].end()) {
+        return nullptr;
+    }
+    
+    return &world_it->second;
+}
+
+namespace {
+
+// Red-black tree node: colour + three links around the value
+constexpr std::size_t kTreeNodeOverhead = 4 * sizeof(void*);
+
+std::size_t string_bytes(const std::string& s) {
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+}
+
+std::size_t string_set_bytes(const std::set<std::string>& strings) {
+    std::size_t bytes = strings.size() * (sizeof(std::string) + kTreeNodeOverhead);
+    for (const auto& s : strings) {
+        bytes += string_bytes(s);
+    }
+    return bytes;
+}
+
+} // namespace
+
+KripkeMemoryUsage KripkeModel::memory_usage() const {
+    KripkeMemoryUsage usage;
+    
+    usage.worlds = string_set_bytes(worlds_) + string_bytes(current_world_);
+    
+    usage.relations = accessibility_.capacity() * sizeof(accessibility_[0]);
+    for (const auto& relation : accessibility_) {
+        for (const auto& [from, targets] : relation) {
+            usage.relations += sizeof(std::string) + sizeof(std::set<std::string>) + kTreeNodeOverhead;
+            usage.relations += string_bytes(from) + string_set_bytes(targets);
+        }
+    }
+    
+    for (const auto& [world, props] : valuation_) {
+        usage.valuations += sizeof(std::string) + sizeof(props) + kTreeNodeOverhead + string_bytes(world);
+        for (const auto& [proposition, value] : props) {
+            usage.valuations += sizeof(std::string) + sizeof(bool) + kTreeNodeOverhead;
+            usage.valuations += string_bytes(proposition);
+        }
+    }
+    
+    return usage;
+}
+
+std::size_t KripkeModel::relation_size(Agent agent) const {
+    if (agent >= accessibility_.size()) {
+        return 0;
+    }
+    
+    std::size_t edges = 0;
+    for (const auto& [from, targets] : accessibility_[agent]) {
+        edges += targets.size();
+    }
+    return edges;
+}
+
+bool KripkeModel::is_equivalence(Agent agent) const {
+    for (const auto& w : worlds_) {
+        const auto* own = successors(agent, w);
+        if (own == nullptr || own->count(w) == 0) {
+            return false;
+        }
+        for (const auto& v : *own) {
+            const auto* other = successors(agent, v);
+            if (other == nullptr || *other != *own) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool KripkeModel::is_s5() const {
+    for (Agent a = 0; a < registry_.size(); ++a) {
+        if (!is_equivalence(a)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+AgentMask KripkeModel::agent_mask(const std::set<std::string>& agents) const {
+    AgentMask mask = 0;
+    for (const auto& agent : agents) {
+        mask |= agent_bit(registry_.index(agent));
+    }
+    return mask;
+}
+
 bool KripkeModel::evaluate_knows(
     const std::string& world,
     const std::string& agent,
     const Formula& phi) const {
     
-    // K_a(phi) is true at w iff phi is true at all worlds accessible to agent a from w
-    auto agent_it = accessibility_.find(agent);
-    if (agent_it == accessibility_.end()) {
+    if (!registry_.contains(agent)) {
         return true; // No accessibility relation means vacuously true
     }
     
-    auto from_world_it = agent_it->second.find(world);
-    if (from_world_it == agent_it->second.end()) {
-        return true; // No accessible worlds
-    }
+    return evaluate_knows(world, registry_.index(agent), phi);
+}
+
+bool KripkeModel::evaluate_knows(
+    const std::string& world,
+    Agent agent,
+    const Formula& phi) const {
     
-    const auto& accessible_worlds = from_world_it->second;
-    if (accessible_worlds.empty()) {
+    // K_a(phi) is true at w iff phi is true at all worlds accessible to agent a from w
+    const std::set<std::string>* accessible_worlds = successors(agent, world);
+    if (accessible_worlds == nullptr) {
         return true; // No accessible worlds means vacuously true
     }
     
-    for (const auto& accessible_world : accessible_worlds) {
+    for (const auto& accessible_world : *accessible_worlds) {
         if (!const_cast<Formula&>(phi).evaluate(*this, accessible_world)) {
             return false;
         }
@@ -126,22 +284,21 @@ std::set<std::string> KripkeModel::get_accessible_worlds(
     const std::string& agent,
     const std::string& from_world) const {
     
-    auto agent_it = accessibility_.find(agent);
-    if (agent_it == accessibility_.end()) {
+    if (!registry_.contains(agent)) {
         return {};
     }
     
-    auto world_it = agent_it->second.find(from_world);
-    if (world_it == agent_it->second.end()) {
+    const std::set<std::string>* accessible = successors(registry_.index(agent), from_world);
+    if (accessible == nullptr) {
         return {};
     }
     
-    return world_it->second;
+    return *accessible;
 }
 
 bool KripkeModel::evaluate_common_knowledge(
     const std::string& world,
-    const std::set<std::string>& group,
+    AgentMask group,
     const Formula& phi) const {
     
     // C_G(phi) = phi holds in all worlds reachable by any sequence of 
@@ -160,7 +317,7 @@ bool KripkeModel::evaluate_common_knowledge(
 
 std::set<std::string> KripkeModel::get_group_reachable_worlds(
     const std::string& start_world,
-    const std::set<std::string>& group) const {
+    AgentMask group) const {
     
     std::set<std::string> reachable;
     std::queue<std::string> to_visit;
@@ -172,71 +329,196 @@ std::set<std::string> KripkeModel::get_group_reachable_worlds(
         std::string current = to_visit.front();
         to_visit.pop();
         
-        for (const auto& agent : group) {
-            auto accessible = get_accessible_worlds(agent, current);
+        for_each_agent(group, [&](Agent agent) {
+            const std::set<std::string>* accessible = successors(agent, current);
+            if (accessible == nullptr) {
+                return;
+            }
             
-            for (const auto& w : accessible) {
-                if (reachable.find(w) == reachable.end()) {
-                    reachable.insert(w);
+            for (const auto& w : *accessible) {
+                if (reachable.insert(w).second) {
                     to_visit.push(w);
                 }
             }
-        }
+        });
     }
     
     return reachable;
 }
 
-void KripkeModel::public_announcement(const Formula& phi) {
-    // Public announcement: remove all worlds where phi is false
-    std::set<std::string> worlds_to_remove;
+bool KripkeModel::public_announcement(const Formula& phi) {
+    // Public announcement: remove all worlds where phi is false.
+    // Evaluate everything first, since phi may look at other worlds.
+    std::vector<std::string> worlds_to_remove;
     
     for (const auto& world : worlds_) {
         if (!phi.evaluate(*this, world)) {
-            worlds_to_remove.insert(world);
+            worlds_to_remove.push_back(world);
         }
     }
     
-    for (const auto& world : worlds_to_remove) {
-        remove_world(world);
+    return !remove_worlds(worlds_to_remove);
+}
+
+static bool test_bit(const std::vector<std::uint64_t>& bits, std::size_t i) {
+    return (bits[i >> 6] >> (i & 63)) & 1U;
+}
+
+std::unordered_map<std::string, std::size_t> KripkeModel::world_ordinals() const {
+    std::unordered_map<std::string, std::size_t> ordinals;
+    ordinals.reserve(worlds_.size());
+    
+    for (const auto& world : worlds_) {
+        ordinals.emplace(world, ordinals.size());
     }
+    
+    return ordinals;
 }
 
-void KripkeModel::private_observation(const std::string& agent, const Formula& phi) {
-    // Private observation: only the observing agent updates their knowledge
-    // Create new worlds for different observations
-    // TODO: DEL would use product update
+std::vector<std::uint64_t> KripkeModel::extension_bits(
+    const Formula& phi,
+    const std::unordered_map<std::string, std::size_t>& ordinals) const {
     
-    std::set<std::string> worlds_where_phi_true;
-    std::set<std::string> worlds_where_phi_false;
+    std::vector<std::uint64_t> bits((worlds_.size() + 63) / 64, 0);
     
     for (const auto& world : worlds_) {
         if (phi.evaluate(*this, world)) {
-            worlds_where_phi_true.insert(world);
-        } else {
-            worlds_where_phi_false.insert(world);
+            const std::size_t i = ordinals.at(world);
+            bits[i >> 6] |= std::uint64_t{1} << (i & 63);
+        }
+    }
+    
+    return bits;
+}
+
+bool KripkeModel::evaluate_distributed_knowledge(
+    const std::string& world,
+    AgentMask group,
+    const Formula& phi) const {
+    
+    // The empty group considers every world possible
+    if (group == 0) {
+        for (const auto& w : worlds_) {
+            if (!phi.evaluate(*this, w)) return false;
+        }
+        return true;
+    }
+    
+    // Walk the smallest successor set and keep the worlds every other
+    // agent in the group also considers possible
+    std::vector<const std::set<std::string>*> sets;
+    for (AgentMask rest = group; rest != 0; rest &= rest - 1) {
+        const std::set<std::string>* accessible = successors(lowest_agent(rest), world);
+        if (accessible == nullptr) {
+            return true; // Empty intersection means vacuously true
         }
+        sets.push_back(accessible);
     }
     
-    auto& agent_accessibility = accessibility_[agent];
+    std::iter_swap(sets.begin(), std::min_element(sets.begin(), sets.end(),
+        [](const auto* a, const auto* b) { return a->size() < b->size(); }));
+    
+    for (const auto& w : *sets.front()) {
+        const bool shared = std::all_of(sets.begin() + 1, sets.end(),
+            [&](const auto* other) { return other->count(w) != 0; });
+        if (shared && !phi.evaluate(*this, w)) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+std::string KripkeModel::fresh_world_name(const std::string& base) const {
+    std::string name = base + "'";
+    while (worlds_.count(name)) {
+        name += "'";
+    }
+    return name;
+}
+
+void KripkeModel::private_observation(const std::string& agent, const Formula& phi) {
+    // Private observation: only the observing agent updates their knowledge.
+    // Evaluate phi once per world, then filter that agent's edges in place.
+    const auto ordinals = world_ordinals();
+    const auto phi_bits = extension_bits(phi, ordinals);
+    
+    auto& agent_accessibility = accessibility_[registry_.index(agent)];
     
     for (auto& from_pair : agent_accessibility) {
-        std::set<std::string> new_accessible;
+        const bool from_satisfies_phi = test_bit(phi_bits, ordinals.at(from_pair.first));
+        auto& accessible = from_pair.second;
         
-        bool from_satisfies_phi = (worlds_where_phi_true.find(from_pair.first) != 
-                                   worlds_where_phi_true.end());
+        // Keep edge only if both satisfy phi or both don't
+        for (auto to_it = accessible.begin(); to_it != accessible.end();) {
+            if (test_bit(phi_bits, ordinals.at(*to_it)) != from_satisfies_phi) {
+                to_it = accessible.erase(to_it);
+            } else {
+                ++to_it;
+            }
+        }
+    }
+}
+
+void KripkeModel::private_announcement(const std::string& agent, const Formula& phi) {
+    const Agent observer = registry_.index(agent);
+    
+    const auto ordinals = world_ordinals();
+    const auto phi_bits = extension_bits(phi, ordinals);
+    
+    // (w,e) copies of the phi-worlds; (w,s) keeps the name w
+    std::map<std::string, std::string> e_copy;
+    for (const auto& world : worlds_) {
+        if (test_bit(phi_bits, ordinals.at(world))) {
+            e_copy.emplace(world, std::string());
+        }
+    }
+    for (auto& [world, copy] : e_copy) {
+        copy = fresh_world_name(world);
+        worlds_.insert(copy);
+    }
+    
+    for (const auto& [world, copy] : e_copy) {
+        auto val_it = valuation_.find(world);
+        if (val_it != valuation_.end()) {
+            valuation_[copy] = val_it->second;
+        }
+    }
+    
+    // Edges out of (w,e): the observer stays among e-copies,
+    // everyone else sees the untouched s-layer.
+    for (Agent a = 0; a < accessibility_.size(); ++a) {
+        auto& relation = accessibility_[a];
+        std::vector<std::pair<std::string, std::set<std::string>>> added;
         
-        for (const auto& to_world : from_pair.second) {
-            bool to_satisfies_phi = (worlds_where_phi_true.find(to_world) != 
-                                     worlds_where_phi_true.end());
+        for (const auto& [from, copy] : e_copy) {
+            auto from_it = relation.find(from);
+            if (from_it == relation.end()) {
+                continue;
+            }
             
-            // Keep edge only if both satisfy phi or both don't
-            if (from_satisfies_phi == to_satisfies_phi) {
-                new_accessible.insert(to_world);
+            std::set<std::string> targets;
+            for (const auto& to : from_it->second) {
+                if (a != observer) {
+                    targets.insert(to);
+                } else {
+                    auto to_copy = e_copy.find(to);
+                    if (to_copy != e_copy.end()) {
+                        targets.insert(to_copy->second);
+                    }
+                }
             }
+            added.emplace_back(copy, std::move(targets));
         }
         
-        from_pair.second = new_accessible;
+        for (auto& [from, targets] : added) {
+            relation[from] = std::move(targets);
+        }
+    }
+    
+    auto current_copy = e_copy.find(current_world_);
+    if (current_copy != e_copy.end()) {
+        current_world_ = current_copy->second;
     }
 }
 
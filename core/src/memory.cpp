@@ -0,0 +1,250 @@
+#include "epistemic/memory.hpp"
+#include "epistemic/dedup.hpp"
+#include "epistemic/quadtree_map.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
+
+namespace epistemic {
+
+namespace {
+
+// libstdc++-style hash node: next pointer + value + cached hash
+template <typename Map>
+std::size_t hash_map_bytes(const Map& m) {
+  using Node = typename Map::value_type;
+  return m.bucket_count() * sizeof(void*) +
+         m.size() * (sizeof(Node) + 2 * sizeof(void*));
+}
+
+template <typename T>
+std::size_t vector_bytes(const std::vector<T>& v) {
+  return v.capacity() * sizeof(T);
+}
+
+/**
+ * Keep designated worlds and whatever they reach; sort and dedupe each
+ * relation; release slack.
+ */
+void compact(BeliefState& belief) {
+  auto& worlds = belief.model.worlds;
+  auto& accessibility = belief.model.accessibility;
+
+  std::unordered_map<WorldId, std::vector<WorldId>> succ;
+  for (const auto& rel : accessibility) {
+    for (const auto& [w1, w2] : rel) succ[w1].push_back(w2);
+  }
+
+  std::unordered_set<WorldId> live(belief.designated.begin(), belief.designated.end());
+  std::vector<WorldId> stack(belief.designated.begin(), belief.designated.end());
+  while (!stack.empty()) {
+    const WorldId w = stack.back();
+    stack.pop_back();
+    for (WorldId v : succ[w]) {
+      if (live.insert(v).second) stack.push_back(v);
+    }
+  }
+
+  worlds.erase(
+    std::remove_if(worlds.begin(), worlds.end(),
+      [&](const World& w) { return !live.count(w.id); }),
+    worlds.end());
+
+  for (World& w : worlds) {
+    w.map.drop_caches();
+    w.map.shrink_to_fit();
+  }
+  worlds.shrink_to_fit();
+
+  for (auto& rel : accessibility) {
+    rel.erase(
+      std::remove_if(rel.begin(), rel.end(), [&](const auto& e) {
+        return !live.count(e.first) || !live.count(e.second);
+      }),
+      rel.end());
+    std::sort(rel.begin(), rel.end());
+    rel.erase(std::unique(rel.begin(), rel.end()), rel.end());
+    rel.shrink_to_fit();
+  }
+
+  belief.designated.shrink_to_fit();
+}
+
+/** Rough bytes a world accounts for, edges included. */
+std::size_t world_bytes(
+  const World& w,
+  std::size_t edges
+) {
+  return sizeof(World) +
+         w.map.cell_bytes() +
+         w.map.cache_bytes() +
+         (w.sparse_map ? w.sparse_map->memory_bytes() : 0) +
+         hash_map_bytes(w.poses) + hash_map_bytes(w.goals) +
+         edges * sizeof(std::pair<WorldId, WorldId>);
+}
+
+/** Drop the lowest-scoring designated worlds until `excess` is freed. */
+std::size_t prune(
+  BeliefState& belief,
+  std::size_t excess,
+  const std::function<double(const World&)>& score
+) {
+  auto& worlds = belief.model.worlds;
+
+  std::unordered_map<WorldId, std::size_t> edges;
+  for (const auto& rel : belief.model.accessibility) {
+    for (const auto& [w1, w2] : rel) {
+      ++edges[w1];
+      ++edges[w2];
+    }
+  }
+
+  std::unordered_map<WorldId, std::size_t> position;
+  for (std::size_t i = 0; i < belief.designated.size(); ++i) {
+    position.emplace(belief.designated[i], i);
+  }
+
+  // Candidates: designated worlds, worst first. Always keep one.
+  std::vector<std::pair<double, const World*>> candidates;
+  for (const World& w : worlds) {
+    auto it = position.find(w.id);
+    if (it == position.end()) continue;
+
+    const double s = score ? score(w) : -static_cast<double>(it->second);
+    candidates.push_back({s, &w});
+  }
+  std::sort(candidates.begin(), candidates.end(),
+    [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  std::unordered_set<WorldId> doomed;
+  std::size_t freed = 0;
+  for (std::size_t i = 0; i + 1 < candidates.size() && freed < excess; ++i) {
+    const World& w = *candidates[i].second;
+    freed += world_bytes(w, edges[w.id]);
+    doomed.insert(w.id);
+  }
+
+  worlds.erase(
+    std::remove_if(worlds.begin(), worlds.end(),
+      [&](const World& w) { return doomed.count(w.id) > 0; }),
+    worlds.end());
+
+  for (auto& rel : belief.model.accessibility) {
+    rel.erase(
+      std::remove_if(rel.begin(), rel.end(), [&](const auto& e) {
+        return doomed.count(e.first) || doomed.count(e.second);
+      }),
+      rel.end());
+  }
+
+  belief.designated.erase(
+    std::remove_if(belief.designated.begin(), belief.designated.end(),
+      [&](WorldId w) { return doomed.count(w) > 0; }),
+    belief.designated.end());
+
+  return doomed.size();
+}
+
+} // namespace
+
+MemoryReport measure_memory(const BeliefState& belief) {
+  MemoryReport r;
+
+  r.worlds = vector_bytes(belief.model.worlds);
+  for (const World& w : belief.model.worlds) {
+    r.maps += w.map.cell_bytes();
+    if (w.sparse_map) r.maps += w.sparse_map->memory_bytes();
+    r.map_caches += w.map.cache_bytes();
+    r.poses += hash_map_bytes(w.poses);
+
+    r.goals += hash_map_bytes(w.goals);
+    for (const auto& [agent, goal] : w.goals) {
+      if (goal.capacity() > 15) r.goals += goal.capacity() + 1;  // beyond SSO
+    }
+  }
+
+  r.relations = vector_bytes(belief.model.accessibility);
+  for (const auto& rel : belief.model.accessibility) {
+    r.relations += vector_bytes(rel);
+  }
+
+  r.designated = vector_bytes(belief.designated);
+  return r;
+}
+
+MemoryReport measure_memory(const EventModel& events) {
+  MemoryReport r;
+
+  r.formulas = vector_bytes(events.events);
+  for (const Event& e : events.events) {
+    r.formulas += formula_bytes(e.precondition) - sizeof(Formula);
+  }
+
+  r.relations = vector_bytes(events.accessibility);
+  for (const auto& rel : events.accessibility) {
+    r.relations += vector_bytes(rel);
+  }
+  return r;
+}
+
+std::size_t formula_bytes(const Formula& phi) {
+  return sizeof(Formula) + std::visit([](auto&& arg) -> std::size_t {
+
+    using T = std::decay_t<decltype(arg)>;
+
+    if constexpr (std::is_same_v<T, Atom>) {
+      return arg.name.capacity() > 15 ? arg.name.capacity() + 1 : 0;
+    }
+    else if constexpr (std::is_same_v<T, Not> ||
+                       std::is_same_v<T, Knows> ||
+                       std::is_same_v<T, DistributedKnowledge>) {
+      return formula_bytes(*arg.phi);
+    }
+    else if constexpr (std::is_same_v<T, And>) {
+      return formula_bytes(*arg.left) + formula_bytes(*arg.right);
+    }
+    else {
+      return 0;
+    }
+
+  }, phi.value);
+}
+
+BudgetResult enforce_budget(
+  BeliefState& belief,
+  const MemoryBudget& budget
+) {
+  BudgetResult result;
+  result.before = measure_memory(belief);
+  result.after = result.before;
+
+  auto fits = [&] {
+    return budget.max_bytes == 0 || result.after.total() <= budget.max_bytes;
+  };
+
+  if (fits()) return result;
+
+  compact(belief);
+  result.after = measure_memory(belief);
+
+  if (!fits() && budget.allow_deduplicate) {
+    DedupStats stats;
+    belief = deduplicate_worlds(belief, DedupMode::Bisimulation, &stats);
+    result.merged_worlds = stats.worlds_before - stats.worlds_after;
+    result.after = measure_memory(belief);
+  }
+
+  if (!fits() && budget.allow_prune) {
+    result.pruned_worlds =
+      prune(belief, result.after.total() - budget.max_bytes, budget.score);
+    result.after = measure_memory(belief);
+  }
+
+  belief.touch();
+  result.within_budget = fits();
+  return result;
+}
+
+} // namespace epistemic
@@ -0,0 +1,337 @@
+#include "epistemic/planner.hpp"
+#include "epistemic/concurrent_table.hpp"
+#include "epistemic/del_update.hpp"
+#include "epistemic/fingerprint.hpp"
+#include "epistemic/formula_parser.hpp"
+#include "epistemic/query.hpp"
+#include "epistemic/typed_events.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace epistemic {
+
+namespace {
+
+constexpr std::size_t kNoParent = static_cast<std::size_t>(-1);
+
+struct SearchNode {
+  BeliefState state;
+  std::size_t parent = kNoParent;
+  std::size_t action = 0;
+  std::size_t depth = 0;
+  double g = 0.0;
+  double h = 0.0;
+  bool goal = false;
+};
+
+struct Successor {
+  std::optional<BeliefState> state;
+  bool goal = false;
+  double h = 0.0;
+};
+
+// Visited states with the best cost reached so far.
+class TranspositionTable {
+public:
+  explicit TranspositionTable(const PlannerOptions& options)
+    : enabled_(options.detect_duplicates),
+      table_(enabled_ ? initial_capacity(options) : 0) {}
+
+  /**
+   * Grow so that `incoming` more states keep the table at most half
+   * full. Call between rounds, never while admit() may run.
+   */
+  void reserve(std::size_t incoming) {
+    if (!enabled_) return;
+
+    const std::size_t needed = 2 * (table_.size() + incoming);
+    if (needed > table_.capacity()) table_.rehash(needed);
+  }
+
+  /**
+   * False if `state` was already reached with cost <= g.
+   */
+  bool admit(const BeliefState& state, double g) {
+    if (!enabled_) return true;
+
+    // Non-negative doubles order like their bit patterns.
+    std::uint64_t g_bits;
+    std::memcpy(&g_bits, &g, sizeof g_bits);
+
+    if (table_.insert_or_min(belief_fingerprint(state), g_bits)) {
+      return true;
+    }
+    duplicates_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  std::size_t duplicates() const { return duplicates_.load(); }
+
+private:
+  static std::size_t initial_capacity(const PlannerOptions& options) {
+    return options.table_capacity ? options.table_capacity : kInitialSlots;
+  }
+
+  // Most plans finish long before max_expansions; start small and let
+  // reserve() follow the frontier.
+  static constexpr std::size_t kInitialSlots = 1024;
+
+  bool enabled_;
+  ConcurrentFingerprintTable table_;
+  std::atomic<std::size_t> duplicates_{0};
+};
+
+PlanResult extract_plan(
+  const std::deque<SearchNode>& nodes,
+  std::size_t index,
+  PlanResult result
+) {
+  result.found = true;
+  result.cost = nodes[index].g;
+
+  for (std::size_t i = index; nodes[i].parent != kNoParent; i = nodes[i].parent) {
+    result.actions.push_back(nodes[i].action);
+  }
+  std::reverse(result.actions.begin(), result.actions.end());
+  return result;
+}
+
+} // namespace
+
+Planner::Planner(std::vector<Action> actions, ThreadPool& pool)
+  : actions_(std::move(actions)), pool_(pool) {}
+
+PlanResult Planner::plan(
+  const BeliefState& initial,
+  const Formula& goal,
+  const PlannerOptions& options
+) const {
+  if (options.strategy == SearchStrategy::BreadthFirst) {
+    return breadth_first(initial, goal, options);
+  }
+  return best_first(initial, goal, options);
+}
+
+PlanResult Planner::breadth_first(
+  const BeliefState& initial,
+  const Formula& goal,
+  const PlannerOptions& options
+) const {
+  PlanResult result;
+  std::deque<SearchNode> nodes;
+  TranspositionTable visited(options);
+
+  nodes.push_back({initial, kNoParent, 0, 0, 0.0, 0.0, false});
+  visited.admit(initial, 0.0);
+  if (holds_in_all(initial, goal)) {
+    return extract_plan(nodes, 0, result);
+  }
+
+  std::vector<std::size_t> frontier{0};
+  const std::size_t A = actions_.size();
+
+  while (!frontier.empty() && result.expanded < options.max_expansions) {
+    if (nodes[frontier.front()].depth >= options.max_depth) break;
+
+    // Expand the whole layer: one task per (node, action)
+    std::vector<Successor> succ(frontier.size() * A);
+    visited.reserve(succ.size());
+
+    pool_.parallel_for(succ.size(), [&](std::size_t job) {
+      const SearchNode& parent = nodes[frontier[job / A]];
+      const Action& action = actions_[job % A];
+
+      BeliefState next = product_update(parent.state, action.event);
+      if (next.empty()) return;
+      renumber_worlds(next);
+      if (!visited.admit(next, parent.g + action.cost)) return;
+
+      succ[job].goal = holds_in_all(next, goal);
+      succ[job].state = std::move(next);
+    });
+
+    result.expanded += frontier.size();
+
+    std::vector<std::size_t> next_frontier;
+    for (std::size_t job = 0; job < succ.size(); ++job) {
+      if (!succ[job].state) continue;
+
+      const std::size_t parent = frontier[job / A];
+      const Action& action = actions_[job % A];
+
+      nodes.push_back({
+        std::move(*succ[job].state),
+        parent,
+        job % A,
+        nodes[parent].depth + 1,
+        nodes[parent].g + action.cost,
+        0.0,
+        succ[job].goal
+      });
+      ++result.generated;
+
+      // BFS: the first goal found is shallowest.
+      if (succ[job].goal) {
+        result.duplicates = visited.duplicates();
+        return extract_plan(nodes, nodes.size() - 1, result);
+      }
+      next_frontier.push_back(nodes.size() - 1);
+    }
+
+    frontier = std::move(next_frontier);
+  }
+
+  result.duplicates = visited.duplicates();
+  return result;
+}
+
+PlanResult Planner::best_first(
+  const BeliefState& initial,
+  const Formula& goal,
+  const PlannerOptions& options
+) const {
+  PlanResult result;
+  std::deque<SearchNode> nodes;
+  TranspositionTable visited(options);
+
+  const bool greedy = options.strategy == SearchStrategy::GreedyBestFirst;
+  auto h = [&](const BeliefState& b) {
+    return options.heuristic ? options.heuristic(b) : 0.0;
+  };
+
+  nodes.push_back({
+    initial, kNoParent, 0, 0, 0.0, h(initial), holds_in_all(initial, goal)
+  });
+  visited.admit(initial, 0.0);
+
+  auto priority = [&](std::size_t i) {
+    return greedy ? nodes[i].h : nodes[i].g + nodes[i].h;
+  };
+
+  // Min-heap on priority; ties favour deeper nodes.
+  auto worse = [&](std::size_t a, std::size_t b) {
+    const double pa = priority(a);
+    const double pb = priority(b);
+    if (pa != pb) return pa > pb;
+    return nodes[a].depth < nodes[b].depth;
+  };
+  std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(worse)>
+    open(worse);
+  open.push(0);
+
+  const std::size_t batch = options.batch_size
+    ? options.batch_size
+    : std::max<std::size_t>(1, pool_.size());
+  const std::size_t A = actions_.size();
+
+  while (!open.empty() && result.expanded < options.max_expansions) {
+    std::vector<std::size_t> round;
+
+    while (!open.empty() && round.size() < batch) {
+      const std::size_t i = open.top();
+      open.pop();
+
+      // Goal test on pop keeps A* optimal (within the batch).
+      if (nodes[i].goal) {
+        result.duplicates = visited.duplicates();
+        return extract_plan(nodes, i, result);
+      }
+      if (nodes[i].depth < options.max_depth) {
+        round.push_back(i);
+      }
+    }
+
+    std::vector<Successor> succ(round.size() * A);
+    visited.reserve(succ.size());
+
+    pool_.parallel_for(succ.size(), [&](std::size_t job) {
+      const SearchNode& parent = nodes[round[job / A]];
+      const Action& action = actions_[job % A];
+
+      BeliefState next = product_update(parent.state, action.event);
+      if (next.empty()) return;
+      renumber_worlds(next);
+      if (!visited.admit(next, parent.g + action.cost)) return;
+
+      succ[job].goal = holds_in_all(next, goal);
+      succ[job].h = h(next);
+      succ[job].state = std::move(next);
+    });
+
+    result.expanded += round.size();
+
+    for (std::size_t job = 0; job < succ.size(); ++job) {
+      if (!succ[job].state) continue;
+
+      const std::size_t parent = round[job / A];
+      const Action& action = actions_[job % A];
+
+      nodes.push_back({
+        std::move(*succ[job].state),
+        parent,
+        job % A,
+        nodes[parent].depth + 1,
+        nodes[parent].g + action.cost,
+        succ[job].h,
+        succ[job].goal
+      });
+      ++result.generated;
+      open.push(nodes.size() - 1);
+    }
+  }
+
+  result.duplicates = visited.duplicates();
+  return result;
+}
+
+Action parse_action(
+  const std::string& spec,
+  std::size_t agent_count
+) {
+  const std::size_t colon = spec.find(':');
+  if (colon == std::string::npos) {
+    throw std::invalid_argument("Action '" + spec + "' lacks ':'");
+  }
+
+  std::string head = spec.substr(0, colon);
+  const Formula phi = parse_formula(spec.substr(colon + 1));
+
+  Action action;
+  const std::size_t bracket = head.find('[');
+  if (bracket == std::string::npos) {
+    action.event = to_event_model(PublicAnnouncementEvent{phi}, agent_count);
+  } else {
+    action.event = to_event_model(
+      SemiPrivateAnnouncementEvent{parse_agent_group(head.substr(bracket)), phi},
+      agent_count);
+    head.resize(bracket);
+  }
+
+  const std::size_t first = head.find_first_not_of(" \t");
+  const std::size_t last = head.find_last_not_of(" \t");
+  if (first == std::string::npos) {
+    throw std::invalid_argument("Action '" + spec + "' has no name");
+  }
+  action.name = head.substr(first, last - first + 1);
+  return action;
+}
+
+Heuristic unsatisfied_worlds_heuristic(Formula goal) {
+  return [goal = std::move(goal)](const BeliefState& b) {
+    double count = 0.0;
+    for (WorldId w : b.designated) {
+      if (!holds(b, w, goal)) count += 1.0;
+    }
+    return count;
+  };
+}
+
+} // namespace epistemic
@@ -0,0 +1,143 @@
+#include "epistemic/pose_table.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace epistemic {
+
+PoseTable::PoseTable(const BeliefState& belief) : version_(belief.version) {
+  const auto& worlds = belief.model.worlds;
+
+  // Agents are dense indices, so the column count is the largest + 1.
+  for (const World& w : worlds) {
+    for (const auto& [a, p] : w.poses) agents_ = std::max<std::size_t>(agents_, a + 1);
+    for (const auto& [a, g] : w.goals) agents_ = std::max<std::size_t>(agents_, a + 1);
+  }
+
+  ids_.reserve(worlds.size());
+  for (const World& w : worlds) ids_.push_back(w.id);
+
+  const std::size_t n = agents_ * ids_.size();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  x_.assign(n, nan);
+  y_.assign(n, nan);
+  theta_.assign(n, nan);
+  goals_.assign(n, kNoGoal);
+
+  for (std::size_t row = 0; row < worlds.size(); ++row) {
+    for (const auto& [a, p] : worlds[row].poses) set_pose(row, a, p);
+    for (const auto& [a, g] : worlds[row].goals) set_goal(row, a, g);
+  }
+}
+
+bool PoseTable::has_pose(std::size_t row, Agent a) const {
+  return a < agents_ && !std::isnan(x_[cell(row, a)]);
+}
+
+Pose PoseTable::pose(std::size_t row, Agent a) const {
+  const std::size_t i = cell(row, a);
+  return Pose{x_[i], y_[i], theta_[i]};
+}
+
+void PoseTable::set_pose(std::size_t row, Agent a, const Pose& p) {
+  const std::size_t i = cell(row, a);
+  x_[i] = p.x;
+  y_[i] = p.y;
+  theta_[i] = p.theta;
+}
+
+GoalId PoseTable::goal(std::size_t row, Agent a) const {
+  return a < agents_ ? goals_[cell(row, a)] : kNoGoal;
+}
+
+void PoseTable::set_goal(std::size_t row, Agent a, const std::string& goal) {
+  goals_[cell(row, a)] = intern(goal);
+}
+
+GoalId PoseTable::goal_id(const std::string& goal) const {
+  auto it = goal_index_.find(goal);
+  return it == goal_index_.end() ? kNoGoal : it->second;
+}
+
+GoalId PoseTable::intern(const std::string& goal) {
+  auto [it, inserted] = goal_index_.try_emplace(
+    goal, static_cast<GoalId>(goal_names_.size()));
+  if (inserted) goal_names_.push_back(goal);
+  return it->second;
+}
+
+std::vector<std::uint8_t> PoseTable::within_mask(
+  Agent a,
+  double px,
+  double py,
+  double r
+) const {
+  const std::size_t n = ids_.size();
+  std::vector<std::uint8_t> mask(n, 0);
+  if (a >= agents_) return mask;
+
+  const double* x = xs(a);
+  const double* y = ys(a);
+  const double r2 = r * r;
+
+  // Branch-free so it vectorizes; NaN rows compare false.
+  for (std::size_t i = 0; i < n; ++i) {
+    const double dx = x[i] - px;
+    const double dy = y[i] - py;
+    mask[i] = static_cast<std::uint8_t>(dx * dx + dy * dy <= r2);
+  }
+  return mask;
+}
+
+std::vector<std::uint8_t> PoseTable::box_mask(
+  Agent a,
+  double x0,
+  double y0,
+  double x1,
+  double y1
+) const {
+  const std::size_t n = ids_.size();
+  std::vector<std::uint8_t> mask(n, 0);
+  if (a >= agents_) return mask;
+
+  const double* x = xs(a);
+  const double* y = ys(a);
+
+  for (std::size_t i = 0; i < n; ++i) {
+    mask[i] = static_cast<std::uint8_t>(
+      (x0 <= x[i]) & (x[i] < x1) & (y0 <= y[i]) & (y[i] < y1));
+  }
+  return mask;
+}
+
+std::vector<WorldId> PoseTable::worlds_within(
+  Agent a,
+  double px,
+  double py,
+  double r
+) const {
+  const auto mask = within_mask(a, px, py, r);
+
+  std::vector<WorldId> out;
+  for (std::size_t i = 0; i < mask.size(); ++i) {
+    if (mask[i]) out.push_back(ids_[i]);
+  }
+  return out;
+}
+
+std::vector<WorldId> PoseTable::worlds_with_goal(
+  Agent a,
+  GoalId goal
+) const {
+  std::vector<WorldId> out;
+  if (a >= agents_ || goal == kNoGoal) return out;
+
+  const GoalId* g = goals_.data() + column(a);
+  for (std::size_t i = 0; i < ids_.size(); ++i) {
+    if (g[i] == goal) out.push_back(ids_[i]);
+  }
+  return out;
+}
+
+} // namespace epistemic
@@ -0,0 +1,285 @@
+#include "epistemic/quadtree_map.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+namespace epistemic {
+
+
+QuadtreeMap::QuadtreeMap(
+  std::uint32_t width,
+  std::uint32_t height,
+  double resolution
+) : width_(width), height_(height), resolution_(resolution) {
+  while (side_ < width_ || side_ < height_) side_ <<= 1;
+
+  // The all-Unknown GridMap of this shape hashes the same
+  GridMap dense;
+  dense.reset(width_, height_, resolution_);
+  hash_ = dense.hash();
+}
+
+QuadtreeMap QuadtreeMap::from_dense(const GridMap& map) {
+  QuadtreeMap tree;
+  tree.width_ = map.width;
+  tree.height_ = map.height;
+  tree.resolution_ = map.resolution;
+  while (tree.side_ < tree.width_ || tree.side_ < tree.height_) tree.side_ <<= 1;
+
+  tree.root_ = tree.build(map, 0, 0, tree.side_);
+  tree.hash_ = map.hash();
+  return tree;
+}
+
+QuadtreeMap::Ref QuadtreeMap::build(
+  const GridMap& map,
+  std::uint32_t x,
+  std::uint32_t y,
+  std::uint32_t size
+) {
+  // Padding beyond the map reads as Unknown
+  if (x >= width_ || y >= height_) return leaf(CellState::Unknown);
+  if (size == 1) return leaf(map.at(x, y));
+
+  // The bottom level reads its four cells directly; it is three
+  // quarters of all calls.
+  const std::uint32_t h = size / 2;
+  const Node node = size == 2
+    ? Node{{
+        leaf(map.at(x, y)),
+        x + 1 < width_ ? leaf(map.at(x + 1, y)) : leaf(CellState::Unknown),
+        y + 1 < height_ ? leaf(map.at(x, y + 1)) : leaf(CellState::Unknown),
+        x + 1 < width_ && y + 1 < height_ ? leaf(map.at(x + 1, y + 1)) : leaf(CellState::Unknown)
+      }}
+    : Node{{
+        build(map, x, y, h),
+        build(map, x + h, y, h),
+        build(map, x, y + h, h),
+        build(map, x + h, y + h, h)
+      }};
+
+  // Children are built collapsed, so uniform means four equal leaves.
+  if (is_leaf(node.child[0]) &&
+      node.child[0] == node.child[1] &&
+      node.child[0] == node.child[2] &&
+      node.child[0] == node.child[3]) {
+    return node.child[0];
+  }
+  return allocate(node);
+}
+
+GridMap QuadtreeMap::to_dense() const {
+  GridMap map;
+  map.reset(width_, height_, resolution_);
+
+  fill(map, root_, 0, 0, side_);
+  return map;
+}
+
+void QuadtreeMap::fill(
+  GridMap& map,
+  Ref r,
+  std::uint32_t x,
+  std::uint32_t y,
+  std::uint32_t size
+) const {
+  if (x >= width_ || y >= height_) return;
+
+  if (is_leaf(r)) {
+    const CellState s = leaf_state(r);
+    if (s == CellState::Unknown) return; // already
+
+    const std::uint32_t x_end = std::min(width_, x + size);
+    const std::uint32_t y_end = std::min(height_, y + size);
+    for (std::uint32_t row = y; row < y_end; ++row) {
+      map.fill(static_cast<std::size_t>(row) * width_ + x, x_end - x, s);
+    }
+    return;
+  }
+
+  const std::uint32_t h = size / 2;
+  const Node& node = nodes_[r];
+  fill(map, node.child[0], x, y, h);
+  fill(map, node.child[1], x + h, y, h);
+  fill(map, node.child[2], x, y + h, h);
+  fill(map, node.child[3], x + h, y + h, h);
+}
+
+CellState QuadtreeMap::at(std::uint32_t x, std::uint32_t y) const {
+  // Past side_ the descent would wrap onto in-range cells.
+  if (x >= width_ || y >= height_) return CellState::Unknown;
+
+  Ref r = root_;
+  std::uint32_t h = side_ / 2;
+
+  while (!is_leaf(r)) {
+    const int q = (x >= h ? 1 : 0) | (y >= h ? 2 : 0);
+    if (x >= h) x -= h;
+    if (y >= h) y -= h;
+    r = nodes_[r].child[q];
+    h /= 2;
+  }
+  return leaf_state(r);
+}
+
+QuadtreeMap::Block QuadtreeMap::block_at(std::uint32_t x, std::uint32_t y) const {
+  if (x >= width_ || y >= height_) return {x, y, 1, CellState::Unknown};
+
+  Ref r = root_;
+  std::uint32_t bx = 0;
+  std::uint32_t by = 0;
+  std::uint32_t size = side_;
+
+  while (!is_leaf(r)) {
+    size /= 2;
+    const int q = (x >= bx + size ? 1 : 0) | (y >= by + size ? 2 : 0);
+    if (q & 1) bx += size;
+    if (q & 2) by += size;
+    r = nodes_[r].child[q];
+  }
+  return {bx, by, size, leaf_state(r)};
+}
+
+std::shared_ptr<const DistanceField> QuadtreeMap::distance_field() const {
+  if (auto field = std::atomic_load(&field_)) return field;
+
+  // Racing builders get the same field from GridMap's shared cache.
+  auto field = to_dense().distance_field();
+  std::atomic_store(&field_, field);
+  return field;
+}
+
+void QuadtreeMap::set(std::uint32_t x, std::uint32_t y, CellState state) {
+  if (x >= width_ || y >= height_) {
+    throw std::out_of_range("Quadtree cell outside the map");
+  }
+
+  field_.reset();
+
+  const std::size_t i = static_cast<std::size_t>(y) * width_ + x;
+  hash_ ^= GridMap::cell_key(i, at(x, y)) ^ GridMap::cell_key(i, state);
+  root_ = set(root_, x, y, side_, state);
+}
+
+QuadtreeMap::Ref QuadtreeMap::set(
+  Ref r,
+  std::uint32_t x,
+  std::uint32_t y,
+  std::uint32_t size,
+  CellState s
+) {
+  if (is_leaf(r)) {
+    if (leaf_state(r) == s) return r;
+    if (size == 1) return leaf(s);
+    r = allocate(Node{{r, r, r, r}});
+  }
+
+  const std::uint32_t h = size / 2;
+  const int q = (x >= h ? 1 : 0) | (y >= h ? 2 : 0);
+
+  // The recursion may grow nodes_, so index again afterwards.
+  const Ref child = set(nodes_[r].child[q], x >= h ? x - h : x, y >= h ? y - h : y, h, s);
+  nodes_[r].child[q] = child;
+
+  const Node& node = nodes_[r];
+  if (is_leaf(child) &&
+      node.child[0] == child &&
+      node.child[1] == child &&
+      node.child[2] == child &&
+      node.child[3] == child) {
+    release(r);
+    return child;
+  }
+  return r;
+}
+
+std::uint32_t QuadtreeMap::count(
+  std::uint32_t x0,
+  std::uint32_t y0,
+  std::uint32_t x1,
+  std::uint32_t y1,
+  CellState s
+) const {
+  return count(root_, 0, 0, side_, x0, y0, x1, y1, s);
+}
+
+std::uint32_t QuadtreeMap::count(
+  Ref r,
+  std::uint32_t x,
+  std::uint32_t y,
+  std::uint32_t size,
+  std::uint32_t x0,
+  std::uint32_t y0,
+  std::uint32_t x1,
+  std::uint32_t y1,
+  CellState s
+) const {
+  const std::uint32_t ix0 = std::max(x, x0);
+  const std::uint32_t iy0 = std::max(y, y0);
+  const std::uint32_t ix1 = std::min(x + (size - 1), x1);
+  const std::uint32_t iy1 = std::min(y + (size - 1), y1);
+  if (ix0 > ix1 || iy0 > iy1) return 0;
+
+  if (is_leaf(r)) {
+    return leaf_state(r) == s ? (ix1 - ix0 + 1) * (iy1 - iy0 + 1) : 0;
+  }
+
+  const std::uint32_t h = size / 2;
+  const Node& node = nodes_[r];
+  return count(node.child[0], x, y, h, x0, y0, x1, y1, s) +
+         count(node.child[1], x + h, y, h, x0, y0, x1, y1, s) +
+         count(node.child[2], x, y + h, h, x0, y0, x1, y1, s) +
+         count(node.child[3], x + h, y + h, h, x0, y0, x1, y1, s);
+}
+
+bool QuadtreeMap::region_free(
+  std::uint32_t x0,
+  std::uint32_t y0,
+  std::uint32_t x1,
+  std::uint32_t y1
+) const {
+  return count(x0, y0, x1, y1, CellState::Free) ==
+         (x1 - x0 + 1) * (y1 - y0 + 1);
+}
+
+std::size_t QuadtreeMap::memory_bytes() const {
+  return sizeof(*this) +
+         nodes_.capacity() * sizeof(Node) +
+         free_.capacity() * sizeof(Ref);
+}
+
+bool QuadtreeMap::operator==(const QuadtreeMap& other) const {
+  return width_ == other.width_ &&
+         height_ == other.height_ &&
+         hash_ == other.hash_ &&
+         equal(root_, other, other.root_);
+}
+
+bool QuadtreeMap::equal(Ref a, const QuadtreeMap& other, Ref b) const {
+  // Both trees are kept fully collapsed, so equal cells mean equal shape.
+  if (is_leaf(a) || is_leaf(b)) return a == b;
+
+  for (int q = 0; q < 4; ++q) {
+    if (!equal(nodes_[a].child[q], other, other.nodes_[b].child[q])) return false;
+  }
+  return true;
+}
+
+QuadtreeMap::Ref QuadtreeMap::allocate(const Node& node) {
+  if (!free_.empty()) {
+    const Ref r = free_.back();
+    free_.pop_back();
+    nodes_[r] = node;
+    return r;
+  }
+
+  nodes_.push_back(node);
+  return static_cast<Ref>(nodes_.size() - 1);
+}
+
+void QuadtreeMap::release(Ref r) {
+  free_.push_back(r);
+}
+
+} // namespace epistemic
@@ -2,6 +2,10 @@
 #include "epistemic/atom_interpretation.hpp"
 
 #include <algorithm>
+#include <functional>
+#include <iterator>
+#include <variant>
+#include <vector>
 
 namespace epistemic {
 
@@ -15,6 +19,24 @@ static const World* find_world(
   return nullptr;
 }
 
+/**
+ * Sorted successors of w for agent a, from one pass over its relation.
+ */
+static std::vector<WorldId> successors(
+  const KripkeModel& model,
+  Agent a,
+  WorldId w
+) {
+  std::vector<WorldId> out;
+  if (a >= model.accessibility.size()) return out;
+
+  for (const auto& [from, to] : model.accessibility[a]) {
+    if (from == w) out.push_back(to);
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
 bool holds(
   const BeliefState& belief,
   WorldId w_id,
@@ -57,6 +79,40 @@ bool holds(
       return true;
     }
 
+    // Distributed knowledge: phi at every world all of the group
+    // consider possible. The empty group pools nothing, so every
+    // designated world counts. Each agent's successors are collected
+    // once and intersected before any designated world is checked.
+    else if constexpr (std::is_same_v<T, DistributedKnowledge>) {
+      std::vector<WorldId> shared;
+      bool first = true;
+
+      for_each_agent(arg.group, [&](Agent a) {
+        if (!first && shared.empty()) return;
+
+        std::vector<WorldId> next = successors(belief.model, a, w_id);
+        if (!first) {
+          std::vector<WorldId> both;
+          std::set_intersection(
+            shared.begin(), shared.end(),
+            next.begin(), next.end(),
+            std::back_inserter(both));
+          next.swap(both);
+        }
+        shared.swap(next);
+        first = false;
+      });
+
+      for (WorldId w2_id : belief.designated) {
+        const bool pooled = arg.group == 0 ||
+          std::binary_search(shared.begin(), shared.end(), w2_id);
+        if (pooled && !holds(belief, w2_id, *arg.phi)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
     else {
       return false;
     }
@@ -76,4 +132,126 @@ bool holds_in_all(
   return true;
 }
 
+static std::size_t hash_mix(std::size_t h, std::size_t v) {
+  return h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+std::size_t formula_hash(
+  const Formula& phi
+) {
+  // Seed with the alternative index so that e.g. Not(p) and Knows(p)
+  // differ. Must cover every alternative that `holds` distinguishes.
+  const std::size_t seed = phi.value.index();
+
+  return std::visit([&](auto&& arg) -> std::size_t {
+
+    using T = std::decay_t<decltype(arg)>;
+
+    if constexpr (std::is_same_v<T, Atom>) {
+      return hash_mix(seed, std::hash<std::string>{}(arg.name));
+    }
+
+    else if constexpr (std::is_same_v<T, Not>) {
+      return hash_mix(seed, formula_hash(*arg.phi));
+    }
+
+    else if constexpr (std::is_same_v<T, And>) {
+      return hash_mix(
+        hash_mix(seed, formula_hash(*arg.left)),
+        formula_hash(*arg.right)
+      );
+    }
+
+    else if constexpr (std::is_same_v<T, Knows>) {
+      return hash_mix(
+        hash_mix(seed, std::hash<Agent>{}(arg.agent)),
+        formula_hash(*arg.phi)
+      );
+    }
+
+    else if constexpr (std::is_same_v<T, DistributedKnowledge>) {
+      return hash_mix(
+        hash_mix(seed, std::hash<AgentMask>{}(arg.group)),
+        formula_hash(*arg.phi)
+      );
+    }
+
+    // Not interpreted by `holds`; formula_equal falls back to identity
+    // for these, so hash the node itself.
+    else {
+      return hash_mix(seed, std::hash<const Formula*>{}(&phi));
+    }
+
+  }, phi.value);
+}
+
+bool formula_equal(
+  const Formula& a,
+  const Formula& b
+) {
+  if (&a == &b) return true;
+  if (a.value.index() != b.value.index()) return false;
+
+  return std::visit([&](auto&& x) -> bool {
+
+    using T = std::decay_t<decltype(x)>;
+    const T& y = std::get<T>(b.value);
+
+    if constexpr (std::is_same_v<T, Atom>) {
+      return x.name == y.name;
+    }
+
+    else if constexpr (std::is_same_v<T, Not>) {
+      return formula_equal(*x.phi, *y.phi);
+    }
+
+    else if constexpr (std::is_same_v<T, And>) {
+      return formula_equal(*x.left, *y.left)
+          && formula_equal(*x.right, *y.right);
+    }
+
+    else if constexpr (std::is_same_v<T, Knows>) {
+      return x.agent == y.agent && formula_equal(*x.phi, *y.phi);
+    }
+
+    else if constexpr (std::is_same_v<T, DistributedKnowledge>) {
+      return x.group == y.group && formula_equal(*x.phi, *y.phi);
+    }
+
+    // Identity only, matching formula_hash.
+    else {
+      return false;
+    }
+
+  }, a.value);
+}
+
+bool formula_cacheable(
+  const Formula& phi
+) {
+  return std::visit([&](auto&& arg) -> bool {
+
+    using T = std::decay_t<decltype(arg)>;
+
+    if constexpr (std::is_same_v<T, Atom>) {
+      return true;
+    }
+
+    else if constexpr (std::is_same_v<T, And>) {
+      return formula_cacheable(*arg.left) && formula_cacheable(*arg.right);
+    }
+
+    else if constexpr (std::is_same_v<T, Not> ||
+                       std::is_same_v<T, Knows> ||
+                       std::is_same_v<T, DistributedKnowledge>) {
+      return formula_cacheable(*arg.phi);
+    }
+
+    else {
+      return false;
+    }
+
+  }, phi.value);
+}
+
 } // namespace epistemic
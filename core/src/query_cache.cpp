@@ -0,0 +1,146 @@
+#include "epistemic/query_cache.hpp"
+#include "epistemic/query.hpp"
+
+namespace epistemic {
+
+void QueryCache::sync(const BeliefState& belief) {
+  if (belief.version == version_) return;
+
+  if (!world_results_.empty() || !all_results_.empty()) {
+    ++stats_.invalidations;
+  }
+  world_results_.clear();
+  all_results_.clear();
+  formulas_.clear();
+  by_hash_.clear();
+  ++epoch_;
+  version_ = belief.version;
+}
+
+std::size_t QueryCache::intern(
+  const Formula& phi,
+  std::size_t hash
+) {
+  auto range = by_hash_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (formula_equal(formulas_[it->second], phi)) return it->second;
+  }
+
+  const std::size_t id = formulas_.size();
+  formulas_.push_back(phi);
+  by_hash_.emplace(hash, id);
+  return id;
+}
+
+bool QueryCache::holds_world(
+  const BeliefState& belief,
+  WorldId w,
+  const Formula& phi,
+  std::size_t hash,
+  bool count
+) {
+  Key key;
+  std::uint64_t epoch;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sync(belief);
+    key = Key{intern(phi, hash), w};
+    epoch = epoch_;
+
+    auto it = world_results_.find(key);
+    if (it != world_results_.end()) {
+      if (count) ++stats_.hits;
+      return it->second;
+    }
+    if (count) ++stats_.misses;
+  }
+
+  const bool result = epistemic::holds(belief, w, phi);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Another thread may have moved the cache to a newer version.
+  if (epoch_ == epoch) {
+    world_results_.emplace(key, result);
+  }
+  return result;
+}
+
+bool QueryCache::holds(
+  const BeliefState& belief,
+  WorldId w,
+  const Formula& phi
+) {
+  if (!formula_cacheable(phi)) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++stats_.misses;
+    }
+    return epistemic::holds(belief, w, phi);
+  }
+  return holds_world(belief, w, phi, formula_hash(phi), true);
+}
+
+bool QueryCache::holds_in_all(
+  const BeliefState& belief,
+  const Formula& phi
+) {
+  if (!formula_cacheable(phi)) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++stats_.misses;
+    }
+    return epistemic::holds_in_all(belief, phi);
+  }
+
+  const std::size_t hash = formula_hash(phi);
+  std::size_t id;
+  std::uint64_t epoch;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sync(belief);
+    id = intern(phi, hash);
+    epoch = epoch_;
+
+    auto it = all_results_.find(id);
+    if (it != all_results_.end()) {
+      ++stats_.hits;
+      return it->second;
+    }
+    ++stats_.misses;
+  }
+
+  // Go through the per-world cache so partial work is reused; those
+  // lookups are part of this miss and are not counted again.
+  bool result = true;
+  for (WorldId w_id : belief.designated) {
+    if (!holds_world(belief, w_id, phi, hash, false)) {
+      result = false;
+      break;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (epoch_ == epoch) {
+    all_results_.emplace(id, result);
+  }
+  return result;
+}
+
+QueryCacheStats QueryCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void QueryCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  world_results_.clear();
+  all_results_.clear();
+  formulas_.clear();
+  by_hash_.clear();
+  ++epoch_;
+  version_ = 0;
+}
+
+} // namespace epistemic
@@ -0,0 +1,452 @@
+#include "epistemic/shm_belief.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace epistemic {
+
+namespace {
+
+constexpr std::uint32_t kMagic = 0x45424c46; // "EBLF"
+constexpr std::uint32_t kLayoutVersion = 2;
+constexpr std::size_t kAlign = 64;
+constexpr int kReadRetries = 16;
+
+std::size_t align_up(std::size_t n, std::size_t a) {
+  return (n + a - 1) / a * a;
+}
+
+/** Bump allocator handing out 8-byte aligned offsets within a slot. */
+class Layout {
+public:
+  explicit Layout(unsigned char* base) : base_(base) {}
+
+  template <typename T>
+  std::uint64_t reserve(std::size_t n) {
+    used_ = align_up(used_, 8);
+    const std::uint64_t offset = used_;
+    used_ += sizeof(T) * n;
+    return offset;
+  }
+
+  template <typename T>
+  T* at(std::uint64_t offset) {
+    return reinterpret_cast<T*>(base_ + offset);
+  }
+
+  std::uint64_t used() const { return used_; }
+
+private:
+  unsigned char* base_;
+  std::uint64_t used_ = 0;
+};
+
+/**
+ * Lay out a snapshot. With Write = false it only measures, so the size
+ * check and the actual write come from the same code path.
+ */
+template <bool Write>
+std::uint64_t emit(unsigned char* base, const BeliefState& belief) {
+  using namespace shm;
+  Layout out(base);
+
+  const auto& worlds = belief.model.worlds;
+  const auto& acc = belief.model.accessibility;
+
+  const std::uint64_t header = out.reserve<SnapshotHeader>(1);
+  const std::uint64_t table = out.reserve<ShmWorld>(worlds.size());
+
+  for (std::size_t i = 0; i < worlds.size(); ++i) {
+    const World& w = worlds[i];
+
+    GridMap scratch;
+    const GridMap& map = w.dense_map(scratch);
+
+    const std::uint64_t cells = out.reserve<CellState>(map.cells().size());
+    const std::uint64_t poses = out.reserve<ShmPose>(w.poses.size());
+    const std::uint64_t goals = out.reserve<ShmGoal>(w.goals.size());
+
+    if constexpr (Write) {
+      ShmWorld& rec = *out.at<ShmWorld>(table + i * sizeof(ShmWorld));
+      rec.id = w.id;
+      rec.width = map.width;
+      rec.height = map.height;
+      rec.resolution = map.resolution;
+      rec.cells_offset = cells;
+      rec.pose_count = w.poses.size();
+      rec.poses_offset = poses;
+      rec.goal_count = w.goals.size();
+      rec.goals_offset = goals;
+
+      if (!map.cells().empty()) {
+        std::memcpy(out.at<CellState>(cells), map.cells().data(), map.cells().size());
+      }
+
+      ShmPose* p = out.at<ShmPose>(poses);
+      for (const auto& [agent, pose] : w.poses) {
+        *p++ = ShmPose{agent, 0, pose.x, pose.y, pose.theta};
+      }
+    }
+
+    std::size_t k = 0;
+    for (const auto& [agent, text] : w.goals) {
+      const std::uint64_t chars = out.reserve<char>(text.size());
+      if constexpr (Write) {
+        ShmGoal& g = out.at<ShmGoal>(goals)[k];
+        g = ShmGoal{agent, static_cast<std::uint32_t>(text.size()), chars};
+        std::memcpy(out.at<char>(chars), text.data(), text.size());
+      }
+      ++k;
+    }
+  }
+
+  const std::uint64_t designated = out.reserve<WorldId>(belief.designated.size());
+  const std::uint64_t relations = out.reserve<ShmRelation>(acc.size());
+
+  for (Agent a = 0; a < acc.size(); ++a) {
+    const std::uint64_t edges = out.reserve<ShmEdge>(acc[a].size());
+    if constexpr (Write) {
+      out.at<ShmRelation>(relations)[a] = ShmRelation{acc[a].size(), edges};
+      ShmEdge* e = out.at<ShmEdge>(edges);
+      for (const auto& [from, to] : acc[a]) *e++ = ShmEdge{from, to};
+    }
+  }
+
+  if constexpr (Write) {
+    if (!belief.designated.empty()) {
+      std::memcpy(
+        out.at<WorldId>(designated),
+        belief.designated.data(),
+        belief.designated.size() * sizeof(WorldId)
+      );
+    }
+
+    SnapshotHeader& h = *out.at<SnapshotHeader>(header);
+    h.version = belief.version;
+    h.bytes_used = out.used();
+    h.world_count = worlds.size();
+    h.worlds_offset = table;
+    h.designated_count = belief.designated.size();
+    h.designated_offset = designated;
+    h.agent_count = acc.size();
+    h.relations_offset = relations;
+  }
+
+  return out.used();
+}
+
+std::size_t region_size(std::size_t slot_capacity) {
+  return align_up(sizeof(shm::RegionHeader), kAlign) + 2 * align_up(slot_capacity, kAlign);
+}
+
+bool process_alive(std::int64_t pid) {
+  return pid > 0 && (kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM);
+}
+
+// True if `name` holds a region whose publisher is still running.
+bool has_live_publisher(const std::string& name) {
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) return false;
+
+  struct stat st;
+  bool live = false;
+  if (fstat(fd, &st) == 0 &&
+      static_cast<std::size_t>(st.st_size) >= sizeof(shm::RegionHeader)) {
+    void* base = mmap(nullptr, sizeof(shm::RegionHeader), PROT_READ, MAP_SHARED, fd, 0);
+    if (base != MAP_FAILED) {
+      const auto& h = *static_cast<const shm::RegionHeader*>(base);
+      live = h.magic == kMagic &&
+             h.layout_version == kLayoutVersion &&
+             process_alive(h.owner_pid);
+      munmap(base, sizeof(shm::RegionHeader));
+    }
+  }
+  close(fd);
+  return live;
+}
+
+void fail_range() {
+  throw std::runtime_error("Belief snapshot offset out of range");
+}
+
+} // namespace
+
+// ---- view ---------------------------------------------------------------
+
+template <typename T>
+const T* BeliefSnapshotView::at(
+  std::uint64_t offset,
+  std::uint64_t count
+) const {
+  if (offset > capacity_ ||
+      offset % alignof(T) != 0 ||
+      count > (capacity_ - offset) / sizeof(T)) {
+    fail_range();
+  }
+  return reinterpret_cast<const T*>(slot_ + offset);
+}
+
+const shm::ShmWorld& BeliefSnapshotView::world(std::size_t i) const {
+  const shm::SnapshotHeader& h = header();
+  if (i >= h.world_count) fail_range();
+  return at<shm::ShmWorld>(h.worlds_offset, h.world_count)[i];
+}
+
+const CellState* BeliefSnapshotView::cells(const shm::ShmWorld& w) const {
+  return at<CellState>(w.cells_offset, static_cast<std::uint64_t>(w.width) * w.height);
+}
+
+const shm::ShmPose* BeliefSnapshotView::poses(const shm::ShmWorld& w) const {
+  return at<shm::ShmPose>(w.poses_offset, w.pose_count);
+}
+
+const shm::ShmGoal* BeliefSnapshotView::goals(const shm::ShmWorld& w) const {
+  return at<shm::ShmGoal>(w.goals_offset, w.goal_count);
+}
+
+std::string BeliefSnapshotView::goal_text(const shm::ShmGoal& g) const {
+  return std::string(at<char>(g.text_offset, g.length), g.length);
+}
+
+const WorldId* BeliefSnapshotView::designated() const {
+  const shm::SnapshotHeader& h = header();
+  return at<WorldId>(h.designated_offset, h.designated_count);
+}
+
+const shm::ShmRelation& BeliefSnapshotView::relation(Agent a) const {
+  const shm::SnapshotHeader& h = header();
+  if (a >= h.agent_count) fail_range();
+  return at<shm::ShmRelation>(h.relations_offset, h.agent_count)[a];
+}
+
+const shm::ShmEdge* BeliefSnapshotView::edges(const shm::ShmRelation& r) const {
+  return at<shm::ShmEdge>(r.edges_offset, r.edge_count);
+}
+
+bool BeliefSnapshotView::still_valid() const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return sequence_->load(std::memory_order_relaxed) == expected_;
+}
+
+BeliefState BeliefSnapshotView::to_belief() const {
+  BeliefState belief;
+
+  // Records are copied out before use, so a concurrent overwrite
+  // cannot change a count between its check and the copy.
+  const shm::SnapshotHeader h = header();
+
+  for (std::size_t i = 0; i < h.world_count; ++i) {
+    if (!still_valid()) {
+      throw std::runtime_error("Belief snapshot overwritten while copying");
+    }
+    const shm::ShmWorld rec = world(i);
+
+    World w;
+    w.id = rec.id;
+    const CellState* c = cells(rec);
+    w.map.assign(
+      rec.width,
+      rec.height,
+      rec.resolution,
+      std::vector<CellState>(c, c + static_cast<std::size_t>(rec.width) * rec.height));
+
+    const shm::ShmPose* p = poses(rec);
+    for (std::size_t k = 0; k < rec.pose_count; ++k) {
+      w.poses[p[k].agent] = Pose{p[k].x, p[k].y, p[k].theta};
+    }
+
+    const shm::ShmGoal* g = goals(rec);
+    for (std::size_t k = 0; k < rec.goal_count; ++k) {
+      const shm::ShmGoal goal = g[k];
+      w.goals[goal.agent] = goal_text(goal);
+    }
+
+    belief.model.worlds.push_back(std::move(w));
+  }
+
+  const WorldId* d = at<WorldId>(h.designated_offset, h.designated_count);
+  belief.designated.assign(d, d + h.designated_count);
+
+  const shm::ShmRelation* relations =
+    at<shm::ShmRelation>(h.relations_offset, h.agent_count);
+  belief.model.accessibility.resize(h.agent_count);
+  for (Agent a = 0; a < h.agent_count; ++a) {
+    const shm::ShmRelation r = relations[a];
+    const shm::ShmEdge* e = edges(r);
+    for (std::size_t k = 0; k < r.edge_count; ++k) {
+      belief.model.accessibility[a].push_back({e[k].from, e[k].to});
+    }
+  }
+
+  if (!still_valid()) {
+    throw std::runtime_error("Belief snapshot overwritten while copying");
+  }
+  return belief;
+}
+
+// ---- publisher ----------------------------------------------------------
+
+ShmBeliefPublisher::ShmBeliefPublisher(
+  const std::string& name,
+  std::size_t slot_capacity
+) : name_(name), size_(region_size(slot_capacity)) {
+
+  // Exclusive, so a second publisher cannot reset the sequence
+  // counters under live readers.
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0 && errno == EEXIST) {
+    if (has_live_publisher(name)) {
+      throw std::runtime_error("Belief region " + name + " already has a publisher");
+    }
+    shm_unlink(name.c_str());
+    fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  }
+  if (fd < 0) {
+    throw std::runtime_error("shm_open failed for " + name);
+  }
+
+  if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+    close(fd);
+    throw std::runtime_error("ftruncate failed for " + name);
+  }
+
+  base_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base_ == MAP_FAILED) {
+    base_ = nullptr;
+    throw std::runtime_error("mmap failed for " + name);
+  }
+
+  auto* h = new (base_) shm::RegionHeader;
+  h->magic = 0;
+  h->layout_version = kLayoutVersion;
+  h->slot_capacity = align_up(slot_capacity, kAlign);
+  h->slot_offset[0] = align_up(sizeof(shm::RegionHeader), kAlign);
+  h->slot_offset[1] = h->slot_offset[0] + h->slot_capacity;
+  h->owner_pid = static_cast<std::int64_t>(getpid());
+  h->slot_sequence[0].store(0);
+  h->slot_sequence[1].store(0);
+  h->latest.store(1);
+  h->publications.store(0);
+
+  std::atomic_thread_fence(std::memory_order_release);
+  h->magic = kMagic;
+}
+
+ShmBeliefPublisher::~ShmBeliefPublisher() {
+  if (base_) munmap(base_, size_);
+  if (unlink_) shm_unlink(name_.c_str());
+}
+
+std::size_t ShmBeliefPublisher::snapshot_size(const BeliefState& belief) {
+  return emit<false>(nullptr, belief);
+}
+
+void ShmBeliefPublisher::publish(const BeliefState& belief) {
+  auto* h = static_cast<shm::RegionHeader*>(base_);
+
+  if (snapshot_size(belief) > h->slot_capacity) {
+    throw std::runtime_error("Belief snapshot exceeds shared-memory slot");
+  }
+
+  // Write into the slot readers are not directed to.
+  const std::uint32_t target = 1 - h->latest.load(std::memory_order_relaxed);
+  auto* slot = static_cast<unsigned char*>(base_) + h->slot_offset[target];
+
+  const std::uint64_t seq = h->slot_sequence[target].load(std::memory_order_relaxed);
+  h->slot_sequence[target].store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  emit<true>(slot, belief);
+
+  h->slot_sequence[target].store(seq + 2, std::memory_order_release);
+  h->latest.store(target, std::memory_order_release);
+  h->publications.fetch_add(1, std::memory_order_release);
+}
+
+std::uint64_t ShmBeliefPublisher::publications() const {
+  return static_cast<const shm::RegionHeader*>(base_)->publications.load();
+}
+
+// ---- subscriber ---------------------------------------------------------
+
+ShmBeliefSubscriber::ShmBeliefSubscriber(const std::string& name) {
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    throw std::runtime_error("No belief region named " + name);
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<std::size_t>(st.st_size) < sizeof(shm::RegionHeader)) {
+    close(fd);
+    throw std::runtime_error("Belief region too small: " + name);
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+
+  base_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base_ == MAP_FAILED) {
+    base_ = nullptr;
+    throw std::runtime_error("mmap failed for " + name);
+  }
+
+  const shm::RegionHeader& h = header();
+  slot_capacity_ = h.slot_capacity;
+  slot_offset_[0] = h.slot_offset[0];
+  slot_offset_[1] = h.slot_offset[1];
+
+  const auto slot_fits = [&](std::uint64_t offset) {
+    return offset >= sizeof(shm::RegionHeader) &&
+           offset % kAlign == 0 &&
+           offset <= size_ &&
+           slot_capacity_ <= size_ - offset;
+  };
+
+  if (h.magic != kMagic || h.layout_version != kLayoutVersion ||
+      slot_capacity_ < sizeof(shm::SnapshotHeader) ||
+      !slot_fits(slot_offset_[0]) || !slot_fits(slot_offset_[1])) {
+    munmap(base_, size_);
+    base_ = nullptr;
+    throw std::runtime_error("Not a belief region: " + name);
+  }
+}
+
+ShmBeliefSubscriber::~ShmBeliefSubscriber() {
+  if (base_) munmap(base_, size_);
+}
+
+std::optional<BeliefSnapshotView> ShmBeliefSubscriber::latest() const {
+  const shm::RegionHeader& h = header();
+
+  for (int attempt = 0; attempt < kReadRetries; ++attempt) {
+    if (h.publications.load(std::memory_order_acquire) == 0) {
+      return std::nullopt;
+    }
+
+    const std::uint32_t s = h.latest.load(std::memory_order_acquire) & 1U;
+    const std::uint64_t seq = h.slot_sequence[s].load(std::memory_order_acquire);
+
+    // Odd: the writer lapped us and is rewriting this slot.
+    if (seq & 1U) continue;
+
+    const auto* slot = static_cast<const unsigned char*>(base_) + slot_offset_[s];
+    return BeliefSnapshotView(slot, slot_capacity_, &h.slot_sequence[s], seq);
+  }
+
+  return std::nullopt;
+}
+
+std::uint64_t ShmBeliefSubscriber::publications() const {
+  return header().publications.load(std::memory_order_acquire);
+}
+
+} // namespace epistemic
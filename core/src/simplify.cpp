@@ -0,0 +1,321 @@
+#include "epistemic/simplify.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace epistemic {
+
+namespace {
+
+using FormulaPtr = std::unique_ptr<Formula>;
+
+bool is_top(const Formula& phi) { return phi.get_type() == FormulaType::TOP; }
+bool is_bottom(const Formula& phi) { return phi.get_type() == FormulaType::BOTTOM; }
+
+/**
+ * @brief Simplifier over the class hierarchy
+ *
+ * Every method returns an already simplified formula, so rebuilt
+ * nodes only need their top level checked.
+ */
+class Simplifier {
+public:
+    explicit Simplifier(const SimplifyOptions& options) : options_(options) {}
+
+    FormulaPtr run(const Formula& phi) {
+        switch (phi.get_type()) {
+            case FormulaType::TOP:
+            case FormulaType::BOTTOM:
+            case FormulaType::ATOM:
+                return phi.clone();
+
+            case FormulaType::NOT:
+                return negate(run(static_cast<const Not&>(phi).get_subformula()));
+
+            case FormulaType::AND: {
+                const auto& f = static_cast<const And&>(phi);
+                return junction(FormulaType::AND, run(f.get_left()), run(f.get_right()));
+            }
+
+            case FormulaType::OR: {
+                const auto& f = static_cast<const Or&>(phi);
+                return junction(FormulaType::OR, run(f.get_left()), run(f.get_right()));
+            }
+
+            case FormulaType::IMPLIES: {
+                const auto& f = static_cast<const Implies&>(phi);
+                return implies(run(f.get_left()), run(f.get_right()));
+            }
+
+            case FormulaType::KNOWS: {
+                const auto& f = static_cast<const Knows&>(phi);
+                return knows(f.get_agent(), run(f.get_subformula()));
+            }
+
+            case FormulaType::EVERYBODY_KNOWS: {
+                const auto& f = static_cast<const EverybodyKnows&>(phi);
+                FormulaPtr sub = run(f.get_subformula());
+                if (is_top(*sub) || f.get_group() == 0) return make_true();
+                return make_everybody_knows(f.get_group(), std::move(sub));
+            }
+
+            case FormulaType::DISTRIBUTED_KNOWLEDGE: {
+                const auto& f = static_cast<const DistributedKnowledge&>(phi);
+                FormulaPtr sub = run(f.get_subformula());
+                if (is_top(*sub)) return make_true();
+                
+                // The intersection of S5 relations is S5 again
+                if (options_.s5 && sub->get_type() == FormulaType::DISTRIBUTED_KNOWLEDGE &&
+                    static_cast<const DistributedKnowledge&>(*sub).get_group() == f.get_group()) {
+                    return sub;
+                }
+                return make_distributed_knowledge(f.get_group(), std::move(sub));
+            }
+
+            case FormulaType::COMMON_KNOWLEDGE: {
+                const auto& f = static_cast<const CommonKnowledge&>(phi);
+                FormulaPtr sub = run(f.get_subformula());
+                if (is_top(*sub)) return make_true();
+
+                // C_G C_G φ ≡ C_G φ (C_G is an S5 modality when each K_a is)
+                if (options_.s5 && sub->get_type() == FormulaType::COMMON_KNOWLEDGE &&
+                    static_cast<const CommonKnowledge&>(*sub).get_group() == f.get_group()) {
+                    return sub;
+                }
+                return make_common_knowledge(f.get_group(), std::move(sub));
+            }
+        }
+        return phi.clone();
+    }
+
+private:
+    /// ¬ of an already simplified formula
+    FormulaPtr negate(FormulaPtr phi) {
+        switch (phi->get_type()) {
+            case FormulaType::TOP:
+                return make_false();
+            case FormulaType::BOTTOM:
+                return make_true();
+            case FormulaType::NOT:
+                return static_cast<const Not&>(*phi).get_subformula().clone();
+            default:
+                break;
+        }
+
+        if (!options_.negation_normal_form) {
+            return make_not(std::move(phi));
+        }
+
+        // De Morgan: operands are simplified, only their negations are new
+        if (phi->get_type() == FormulaType::AND || phi->get_type() == FormulaType::OR) {
+            const FormulaType dual =
+                phi->get_type() == FormulaType::AND ? FormulaType::OR : FormulaType::AND;
+
+            std::vector<FormulaPtr> operands;
+            flatten(phi->get_type(), *phi, operands);
+
+            FormulaPtr result;
+            for (auto& operand : operands) {
+                FormulaPtr negated = negate(std::move(operand));
+                result = result ? junction(dual, std::move(result), std::move(negated))
+                                : std::move(negated);
+            }
+            return result;
+        }
+
+        return make_not(std::move(phi));
+    }
+
+    FormulaPtr implies(FormulaPtr left, FormulaPtr right) {
+        if (options_.negation_normal_form) {
+            return junction(FormulaType::OR, negate(std::move(left)), std::move(right));
+        }
+
+        if (is_bottom(*left) || is_top(*right)) return make_true();
+        if (is_top(*left)) return right;
+        if (is_bottom(*right)) return negate(std::move(left));
+        if (left->to_string() == right->to_string()) return make_true();
+        return make_implies(std::move(left), std::move(right));
+    }
+
+    FormulaPtr knows(Agent agent, FormulaPtr sub) {
+        // Necessitation
+        if (is_top(*sub)) return make_true();
+
+        if (options_.s5) {
+            // Reflexivity: K_a ⊥ is false everywhere
+            if (is_bottom(*sub)) return make_false();
+
+            // Positive introspection: K_a K_a φ ≡ K_a φ
+            if (sub->get_type() == FormulaType::KNOWS &&
+                static_cast<const Knows&>(*sub).get_agent() == agent) {
+                return sub;
+            }
+
+            // Negative introspection: K_a ¬K_a φ ≡ ¬K_a φ
+            if (sub->get_type() == FormulaType::NOT) {
+                const Formula& inner = static_cast<const Not&>(*sub).get_subformula();
+                if (inner.get_type() == FormulaType::KNOWS &&
+                    static_cast<const Knows&>(inner).get_agent() == agent) {
+                    return sub;
+                }
+            }
+        }
+
+        return make_knows(agent, std::move(sub));
+    }
+
+    /// Copy out the operands of a chain of `type` nodes
+    static void flatten(FormulaType type, const Formula& phi, std::vector<FormulaPtr>& out) {
+        if (phi.get_type() != type) {
+            out.push_back(phi.clone());
+            return;
+        }
+
+        if (type == FormulaType::AND) {
+            const auto& f = static_cast<const And&>(phi);
+            flatten(type, f.get_left(), out);
+            flatten(type, f.get_right(), out);
+        } else {
+            const auto& f = static_cast<const Or&>(phi);
+            flatten(type, f.get_left(), out);
+            flatten(type, f.get_right(), out);
+        }
+    }
+
+    /// Flattened, folded and deduplicated ∧ or ∨ of simplified operands
+    FormulaPtr junction(FormulaType type, FormulaPtr left, FormulaPtr right) {
+        const bool conj = type == FormulaType::AND;
+
+        std::vector<FormulaPtr> operands;
+        flatten(type, *left, operands);
+        flatten(type, *right, operands);
+
+        std::vector<FormulaPtr> kept;
+        std::set<std::string> seen;
+
+        for (auto& operand : operands) {
+            // Identity drops out, the absorbing constant wins
+            if (conj ? is_top(*operand) : is_bottom(*operand)) continue;
+            if (conj ? is_bottom(*operand) : is_top(*operand)) {
+                return conj ? make_false() : make_true();
+            }
+
+            if (seen.insert(operand->to_string()).second) {
+                kept.push_back(std::move(operand));
+            }
+        }
+
+        // φ together with ¬φ
+        for (const auto& operand : kept) {
+            if (operand->get_type() != FormulaType::NOT) continue;
+            const Formula& inner = static_cast<const Not&>(*operand).get_subformula();
+            if (seen.count(inner.to_string())) {
+                return conj ? make_false() : make_true();
+            }
+        }
+
+        if (kept.empty()) {
+            return conj ? make_true() : make_false();
+        }
+
+        FormulaPtr result = std::move(kept.front());
+        for (std::size_t i = 1; i < kept.size(); ++i) {
+            result = conj ? make_and(std::move(result), std::move(kept[i]))
+                          : make_or(std::move(result), std::move(kept[i]));
+        }
+        return result;
+    }
+
+    SimplifyOptions options_;
+};
+
+void collect_atoms(const Formula& phi, std::set<std::string>& out) {
+    switch (phi.get_type()) {
+        case FormulaType::TOP:
+        case FormulaType::BOTTOM:
+            return;
+        case FormulaType::ATOM:
+            out.insert(static_cast<const Atom&>(phi).get_proposition());
+            return;
+        case FormulaType::NOT:
+            collect_atoms(static_cast<const Not&>(phi).get_subformula(), out);
+            return;
+        case FormulaType::AND:
+            collect_atoms(static_cast<const And&>(phi).get_left(), out);
+            collect_atoms(static_cast<const And&>(phi).get_right(), out);
+            return;
+        case FormulaType::OR:
+            collect_atoms(static_cast<const Or&>(phi).get_left(), out);
+            collect_atoms(static_cast<const Or&>(phi).get_right(), out);
+            return;
+        case FormulaType::IMPLIES:
+            collect_atoms(static_cast<const Implies&>(phi).get_left(), out);
+            collect_atoms(static_cast<const Implies&>(phi).get_right(), out);
+            return;
+        case FormulaType::KNOWS:
+            collect_atoms(static_cast<const Knows&>(phi).get_subformula(), out);
+            return;
+        case FormulaType::COMMON_KNOWLEDGE:
+            collect_atoms(static_cast<const CommonKnowledge&>(phi).get_subformula(), out);
+            return;
+        case FormulaType::EVERYBODY_KNOWS:
+            collect_atoms(static_cast<const EverybodyKnows&>(phi).get_subformula(), out);
+            return;
+        case FormulaType::DISTRIBUTED_KNOWLEDGE:
+            collect_atoms(static_cast<const DistributedKnowledge&>(phi).get_subformula(), out);
+            return;
+    }
+}
+
+} // namespace
+
+std::unique_ptr<Formula> simplify(const Formula& phi, const SimplifyOptions& options) {
+    return Simplifier(options).run(phi);
+}
+
+SimplifyOptions simplify_options_for(const KripkeModel& model) {
+    SimplifyOptions options;
+    options.s5 = model.is_s5();
+    return options;
+}
+
+int modal_depth(const Formula& phi) {
+    switch (phi.get_type()) {
+        case FormulaType::TOP:
+        case FormulaType::BOTTOM:
+        case FormulaType::ATOM:
+            return 0;
+        case FormulaType::NOT:
+            return modal_depth(static_cast<const Not&>(phi).get_subformula());
+        case FormulaType::AND: {
+            const auto& f = static_cast<const And&>(phi);
+            return std::max(modal_depth(f.get_left()), modal_depth(f.get_right()));
+        }
+        case FormulaType::OR: {
+            const auto& f = static_cast<const Or&>(phi);
+            return std::max(modal_depth(f.get_left()), modal_depth(f.get_right()));
+        }
+        case FormulaType::IMPLIES: {
+            const auto& f = static_cast<const Implies&>(phi);
+            return std::max(modal_depth(f.get_left()), modal_depth(f.get_right()));
+        }
+        case FormulaType::KNOWS:
+            return 1 + modal_depth(static_cast<const Knows&>(phi).get_subformula());
+        case FormulaType::COMMON_KNOWLEDGE:
+            return 1 + modal_depth(static_cast<const CommonKnowledge&>(phi).get_subformula());
+        case FormulaType::EVERYBODY_KNOWS:
+            return 1 + modal_depth(static_cast<const EverybodyKnows&>(phi).get_subformula());
+        case FormulaType::DISTRIBUTED_KNOWLEDGE:
+            return 1 + modal_depth(static_cast<const DistributedKnowledge&>(phi).get_subformula());
+    }
+    return 0;
+}
+
+std::set<std::string> atoms(const Formula& phi) {
+    std::set<std::string> out;
+    collect_atoms(phi, out);
+    return out;
+}
+
+} // namespace epistemic
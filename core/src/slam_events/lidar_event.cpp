@@ -36,7 +36,7 @@ EventModel build_lidar_event(
 
             // Reflexivity
             if (i == j) {
-                em.accessibility[sensing_agent].push_back({i, j});
+                em.add_edge(sensing_agent, i, j);
                 continue;
             }
 
@@ -47,12 +47,12 @@ EventModel build_lidar_event(
             bool rj_invalid = (rj <= 0.0 || rj >= obs.max_range);
 
             if (ri_invalid && rj_invalid) {
-                em.accessibility[sensing_agent].push_back({i, j});
+                em.add_edge(sensing_agent, i, j);
                 continue;
             }
 
             if (std::fabs(ri - rj) <= model.sigma) {
-                em.accessibility[sensing_agent].push_back({i, j});
+                em.add_edge(sensing_agent, i, j);
             }
         }
     }
@@ -62,7 +62,7 @@ EventModel build_lidar_event(
     if (model.dropout_prob > 0.5) {
     for (std::size_t i = 0; i < N; ++i) {
         for (std::size_t j = 0; j < N; ++j) {
-        em.accessibility[sensing_agent].push_back({i, j});
+        em.add_edge(sensing_agent, i, j);
         }
     }
     }
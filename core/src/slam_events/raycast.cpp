@@ -0,0 +1,354 @@
+#include "epistemic/slam_events/raycast.hpp"
+
+#include <cmath>
+#include <limits>
+
+#include "epistemic/del_update.hpp"
+
+namespace epistemic {
+
+namespace {
+
+constexpr double kTwoPi = 6.283185307179586;
+
+// Per thread, so concurrent scopes cannot see each other's scan.
+thread_local const ScanConsistency* active_scan = nullptr;
+
+bool invalid_range(double r, double max_range) {
+  return r <= 0.0 || r >= max_range;
+}
+
+/**
+ * Endpoint test of one scan against a distance field: O(1) per beam
+ * instead of a traversal. `map` is a GridMap or QuadtreeMap.
+ */
+template <class Map>
+void endpoint_agreement(
+  const Map& map,
+  const DistanceField& field,
+  const Pose& pose,
+  const BeamTable& beams,
+  const LidarObservation& obs,
+  double band,
+  std::uint8_t* agrees
+) {
+  const double c = std::cos(pose.theta);
+  const double s = std::sin(pose.theta);
+
+  for (std::size_t i = 0; i < beams.size(); ++i) {
+    const double r = obs.ranges[i];
+    if (invalid_range(r, obs.max_range)) continue;
+
+    const double dx = c * beams.cos_rel[i] - s * beams.sin_rel[i];
+    const double dy = s * beams.cos_rel[i] + c * beams.sin_rel[i];
+    const long cx = static_cast<long>(std::floor((pose.x + r * dx) / field.resolution));
+    const long cy = static_cast<long>(std::floor((pose.y + r * dy) / field.resolution));
+
+    if (cx < 0 || cy < 0 ||
+        cx >= static_cast<long>(field.width) ||
+        cy >= static_cast<long>(field.height) ||
+        map.at(cx, cy) == CellState::Unknown) {
+      continue;
+    }
+
+    agrees[i] = field.at(cx, cy) <= band;
+  }
+}
+
+/**
+ * DDA over the cells of a width x height map with early exit.
+ * `block_at(cx, cy)` returns the uniform block holding a cell; the walk
+ * steps through the rest of that block without further lookups. A
+ * dense map hands out 1 x 1 blocks.
+ */
+template <class BlockAt>
+double walk_ray(
+  std::uint32_t width,
+  std::uint32_t height,
+  double resolution,
+  double x,
+  double y,
+  double dx,
+  double dy,
+  double max_range,
+  const BlockAt& block_at
+) {
+  // Work in cell units; t is the distance travelled along the ray.
+  const double ox = x / resolution;
+  const double oy = y / resolution;
+  const double max_t = max_range / resolution;
+
+  long cx = static_cast<long>(std::floor(ox));
+  long cy = static_cast<long>(std::floor(oy));
+
+  const long w = static_cast<long>(width);
+  const long h = static_cast<long>(height);
+  if (cx < 0 || cy < 0 || cx >= w || cy >= h) {
+    return max_range;
+  }
+
+  const double inf = std::numeric_limits<double>::infinity();
+  const long step_x = dx > 0 ? 1 : -1;
+  const long step_y = dy > 0 ? 1 : -1;
+
+  const double delta_x = dx != 0.0 ? std::fabs(1.0 / dx) : inf;
+  const double delta_y = dy != 0.0 ? std::fabs(1.0 / dy) : inf;
+
+  double next_x = dx != 0.0
+    ? (dx > 0 ? (cx + 1 - ox) : (ox - cx)) * delta_x
+    : inf;
+  double next_y = dy != 0.0
+    ? (dy > 0 ? (cy + 1 - oy) : (oy - cy)) * delta_y
+    : inf;
+
+  double t = 0.0;
+
+  while (t <= max_t) {
+    const QuadtreeMap::Block b = block_at(cx, cy);
+    if (b.state == CellState::Occupied) {
+      return t * resolution;
+    }
+
+    const long x0 = b.x;
+    const long y0 = b.y;
+    const long x1 = x0 + b.size;
+    const long y1 = y0 + b.size;
+
+    do {
+      if (next_x < next_y) {
+        t = next_x;
+        next_x += delta_x;
+        cx += step_x;
+        if (cx < 0 || cx >= w) return max_range;
+      } else {
+        t = next_y;
+        next_y += delta_y;
+        cy += step_y;
+        if (cy < 0 || cy >= h) return max_range;
+      }
+    } while (t <= max_t && cx >= x0 && cx < x1 && cy >= y0 && cy < y1);
+  }
+
+  return max_range;
+}
+
+/** Rotates the shared beam directions into `pose` and casts each. */
+template <class Map>
+void cast_beams(
+  const Map& map,
+  const Pose& pose,
+  const BeamTable& beams,
+  double max_range,
+  double* out
+) {
+  const std::size_t n = beams.size();
+  const double c = std::cos(pose.theta);
+  const double s = std::sin(pose.theta);
+
+  // A straight loop over the table, so it vectorizes.
+  std::vector<double> dx(n);
+  std::vector<double> dy(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    dx[i] = c * beams.cos_rel[i] - s * beams.sin_rel[i];
+    dy[i] = s * beams.cos_rel[i] + c * beams.sin_rel[i];
+  }
+
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = cast_ray(map, pose.x, pose.y, dx[i], dy[i], max_range);
+  }
+}
+
+} // namespace
+
+BeamTable::BeamTable(const LidarObservation& obs) {
+  const std::size_t n = obs.ranges.size();
+  const double step = obs.angle_increment != 0.0
+    ? obs.angle_increment
+    : (n ? kTwoPi / static_cast<double>(n) : 0.0);
+
+  cos_rel.resize(n);
+  sin_rel.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const double a = obs.angle_min + static_cast<double>(i) * step;
+    cos_rel[i] = std::cos(a);
+    sin_rel[i] = std::sin(a);
+  }
+}
+
+double cast_ray(
+  const GridMap& map,
+  double x,
+  double y,
+  double dx,
+  double dy,
+  double max_range
+) {
+  const CellState* cells = map.cells().data();
+  const long w = static_cast<long>(map.width);
+
+  return walk_ray(
+    map.width, map.height, map.resolution, x, y, dx, dy, max_range,
+    [&](long cx, long cy) {
+      return QuadtreeMap::Block{
+        static_cast<std::uint32_t>(cx), static_cast<std::uint32_t>(cy), 1,
+        cells[cy * w + cx]};
+    });
+}
+
+double cast_ray(
+  const QuadtreeMap& map,
+  double x,
+  double y,
+  double dx,
+  double dy,
+  double max_range
+) {
+  return walk_ray(
+    map.width(), map.height(), map.resolution(), x, y, dx, dy, max_range,
+    [&](long cx, long cy) {
+      return map.block_at(static_cast<std::uint32_t>(cx), static_cast<std::uint32_t>(cy));
+    });
+}
+
+void expected_ranges(
+  const GridMap& map,
+  const Pose& pose,
+  const BeamTable& beams,
+  double max_range,
+  double* out
+) {
+  cast_beams(map, pose, beams, max_range, out);
+}
+
+void expected_ranges(
+  const QuadtreeMap& map,
+  const Pose& pose,
+  const BeamTable& beams,
+  double max_range,
+  double* out
+) {
+  cast_beams(map, pose, beams, max_range, out);
+}
+
+std::vector<double> expected_ranges(
+  const GridMap& map,
+  const Pose& pose,
+  const LidarObservation& obs
+) {
+  std::vector<double> out(obs.ranges.size());
+  expected_ranges(map, pose, BeamTable(obs), obs.max_range, out.data());
+  return out;
+}
+
+// ---- ScanConsistency ----------------------------------------------------
+
+ScanConsistency::ScanConsistency(
+  const BeliefState& belief,
+  const LidarObservation& obs,
+  const LidarSensorModel& sensor,
+  ThreadPool& pool,
+  Agent sensing_agent,
+  double tolerance,
+  ScanMethod method
+) : beams_(obs.ranges.size()), max_range_(obs.max_range) {
+
+  const auto& worlds = belief.model.worlds;
+  for (std::size_t row = 0; row < worlds.size(); ++row) {
+    rows_.emplace(worlds[row].id, row);
+  }
+
+  expected_.assign(worlds.size() * beams_, max_range_);
+  agrees_.assign(worlds.size() * beams_, 1);
+
+  const BeamTable table(obs);
+  const double band = tolerance * sensor.sigma;
+  const bool may_drop = sensor.dropout_prob > 0.0;
+
+  pool.parallel_for(worlds.size(), [&](std::size_t row) {
+    const World& w = worlds[row];
+    auto pose = w.poses.find(sensing_agent);
+    if (pose == w.poses.end()) return;
+
+    double* expected = &expected_[row * beams_];
+    std::uint8_t* agrees = &agrees_[row * beams_];
+
+    // Quadtree maps are read in place: rays step over uniform blocks,
+    // and the distance field is built once per shared tree.
+    const QuadtreeMap* tree = w.sparse_map.get();
+
+    if (method == ScanMethod::LikelihoodField) {
+      if (tree) {
+        endpoint_agreement(*tree, *tree->distance_field(), pose->second, table, obs, band, agrees);
+      } else {
+        endpoint_agreement(w.map, *w.map.distance_field(), pose->second, table, obs, band, agrees);
+      }
+      return;
+    }
+
+    if (tree) {
+      expected_ranges(*tree, pose->second, table, max_range_, expected);
+    } else {
+      expected_ranges(w.map, pose->second, table, max_range_, expected);
+    }
+
+    for (std::size_t i = 0; i < beams_; ++i) {
+      const double observed = obs.ranges[i];
+
+      if (invalid_range(observed, max_range_)) {
+        agrees[i] = may_drop || expected[i] >= max_range_;
+      } else {
+        agrees[i] = std::fabs(expected[i] - observed) <= band;
+      }
+    }
+  });
+}
+
+bool ScanConsistency::consistent(
+  WorldId world,
+  std::size_t beam
+) const {
+  auto it = rows_.find(world);
+  if (it == rows_.end() || beam >= beams_) return false;
+  return agrees_[it->second * beams_ + beam];
+}
+
+double ScanConsistency::expected(
+  WorldId world,
+  std::size_t beam
+) const {
+  auto it = rows_.find(world);
+  if (it == rows_.end() || beam >= beams_) return max_range_;
+  return expected_[it->second * beams_ + beam];
+}
+
+// ---- ActiveScan ---------------------------------------------------------
+
+ActiveScan::ActiveScan(const ScanConsistency& scan)
+  : previous_(active_scan) {
+  active_scan = &scan;
+}
+
+ActiveScan::~ActiveScan() {
+  active_scan = previous_;
+}
+
+const ScanConsistency* ActiveScan::current() {
+  return active_scan;
+}
+
+BeliefState lidar_update(
+  const BeliefState& belief,
+  const LidarObservation& obs,
+  const LidarSensorModel& sensor,
+  ThreadPool& pool,
+  ScanMethod method
+) {
+  const ScanConsistency scan(belief, obs, sensor, pool, 0, 3.0, method);
+
+  // Event i's precondition is lidar_bin_i; read it from this scan
+  // rather than whatever ActiveScan is current.
+  return product_update(belief, build_lidar_event(obs, sensor),
+    [&](WorldId w, const Event& e) { return scan.consistent(w, e.id); });
+}
+
+} // namespace epistemic
@@ -0,0 +1,237 @@
+#include "epistemic/slam_events/scan_log.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace epistemic {
+
+namespace {
+
+constexpr char kMagic[4] = {'E', 'S', 'C', 'L'};
+
+// Sanity bound on one frame; a corrupt size must not allocate gigabytes.
+constexpr std::uint64_t kMaxPayload = std::uint64_t{1} << 28;
+
+void put_varint(std::vector<std::uint8_t>& out, std::uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<std::uint8_t>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<std::uint8_t>(v));
+}
+
+void put_f64(std::vector<std::uint8_t>& out, double d) {
+  std::uint64_t u;
+  std::memcpy(&u, &d, sizeof u);
+  for (int i = 0; i < 8; ++i) out.push_back(static_cast<std::uint8_t>(u >> (8 * i)));
+}
+
+double get_f64(const std::uint8_t* p) {
+  std::uint64_t u = 0;
+  for (int i = 0; i < 8; ++i) u |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+  double d;
+  std::memcpy(&d, &u, sizeof d);
+  return d;
+}
+
+std::uint64_t zigzag(std::int64_t v) {
+  return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t u) {
+  return static_cast<std::int64_t>(u >> 1) ^ -static_cast<std::int64_t>(u & 1);
+}
+
+std::int64_t quantize(double r, double max_range, double quantum) {
+  if (!std::isfinite(r) || r <= 0.0 || r >= max_range) return 0;
+  return std::llround(r / quantum) + 1;
+}
+
+bool same_bits(double a, double b) {
+  return std::memcmp(&a, &b, sizeof a) == 0;
+}
+
+class PayloadReader {
+public:
+  PayloadReader(const std::uint8_t* data, std::size_t size)
+    : p_(data), end_(data + size) {}
+
+  std::uint8_t u8() {
+    need(1);
+    return *p_++;
+  }
+
+  std::uint64_t varint() {
+    std::uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const std::uint8_t b = u8();
+      v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+      if (!(b & 0x80)) return v;
+    }
+    throw std::runtime_error("Malformed varint in scan log");
+  }
+
+  double f64() {
+    need(8);
+    const double d = get_f64(p_);
+    p_ += 8;
+    return d;
+  }
+
+  bool done() const { return p_ == end_; }
+
+private:
+  void need(std::size_t n) {
+    if (static_cast<std::size_t>(end_ - p_) < n) {
+      throw std::runtime_error("Truncated scan log frame");
+    }
+  }
+
+  const std::uint8_t* p_;
+  const std::uint8_t* end_;
+};
+
+} // namespace
+
+ScanLogWriter::ScanLogWriter(
+  std::ostream& out,
+  double quantum
+) : out_(out), quantum_(quantum) {
+  if (!(quantum > 0.0)) {
+    throw std::invalid_argument("Scan log quantum must be positive");
+  }
+
+  std::vector<std::uint8_t> header(kMagic, kMagic + 4);
+  header.push_back(kVersion);
+  put_f64(header, quantum_);
+
+  out_.write(reinterpret_cast<const char*>(header.data()), header.size());
+  bytes_ += header.size();
+}
+
+void ScanLogWriter::write(const ScanFrame& frame) {
+  const LidarObservation& obs = frame.obs;
+
+  const bool geometry =
+    !have_geometry_ ||
+    beams_ != obs.ranges.size() ||
+    !same_bits(max_range_, obs.max_range) ||
+    !same_bits(angle_min_, obs.angle_min) ||
+    !same_bits(angle_increment_, obs.angle_increment);
+
+  payload_.clear();
+  payload_.push_back(geometry ? 1 : 0);
+  put_varint(payload_, zigzag(static_cast<std::int64_t>(frame.stamp_ns - last_stamp_)));
+
+  if (geometry) {
+    put_f64(payload_, obs.max_range);
+    put_f64(payload_, obs.angle_min);
+    put_f64(payload_, obs.angle_increment);
+    put_varint(payload_, obs.ranges.size());
+
+    have_geometry_ = true;
+    max_range_ = obs.max_range;
+    angle_min_ = obs.angle_min;
+    angle_increment_ = obs.angle_increment;
+    beams_ = obs.ranges.size();
+  }
+
+  // Neighbouring beams see neighbouring surfaces, so deltas stay small
+  std::int64_t prev = 0;
+  for (double r : obs.ranges) {
+    const std::int64_t q = quantize(r, obs.max_range, quantum_);
+    put_varint(payload_, zigzag(q - prev));
+    prev = q;
+  }
+
+  std::vector<std::uint8_t> size;
+  put_varint(size, payload_.size());
+  out_.write(reinterpret_cast<const char*>(size.data()), size.size());
+  out_.write(reinterpret_cast<const char*>(payload_.data()), payload_.size());
+
+  last_stamp_ = frame.stamp_ns;
+  bytes_ += size.size() + payload_.size();
+  ++frames_;
+}
+
+ScanLogReader::ScanLogReader(std::istream& in) : in_(in) {
+  std::uint8_t header[13];
+  in_.read(reinterpret_cast<char*>(header), sizeof header);
+
+  if (in_.gcount() != static_cast<std::streamsize>(sizeof header) ||
+      std::memcmp(header, kMagic, 4) != 0) {
+    throw std::runtime_error("Not a scan log");
+  }
+  if (header[4] != ScanLogWriter::kVersion) {
+    throw std::runtime_error("Unsupported scan log version");
+  }
+
+  quantum_ = get_f64(header + 5);
+  if (!(quantum_ > 0.0)) {
+    throw std::runtime_error("Scan log quantum must be positive");
+  }
+}
+
+bool ScanLogReader::next(ScanFrame& frame) {
+  std::uint64_t size = 0;
+  for (int shift = 0;; shift += 7) {
+    const int c = in_.get();
+    if (c == std::char_traits<char>::eof()) return false;
+    if (shift >= 64) throw std::runtime_error("Malformed varint in scan log");
+
+    size |= static_cast<std::uint64_t>(c & 0x7f) << shift;
+    if (!(c & 0x80)) break;
+  }
+
+  if (size > kMaxPayload) {
+    throw std::runtime_error("Scan log frame too large");
+  }
+
+  payload_.resize(static_cast<std::size_t>(size));
+  in_.read(reinterpret_cast<char*>(payload_.data()), payload_.size());
+  if (in_.gcount() != static_cast<std::streamsize>(payload_.size())) {
+    return false;
+  }
+
+  PayloadReader r(payload_.data(), payload_.size());
+
+  const std::uint8_t flags = r.u8();
+  last_stamp_ += static_cast<std::uint64_t>(unzigzag(r.varint()));
+
+  if (flags & 1) {
+    max_range_ = r.f64();
+    angle_min_ = r.f64();
+    angle_increment_ = r.f64();
+
+    // Every beam takes at least one byte
+    const std::uint64_t beams = r.varint();
+    if (beams > payload_.size()) {
+      throw std::runtime_error("Scan log beam count exceeds frame size");
+    }
+    beams_ = static_cast<std::size_t>(beams);
+    have_geometry_ = true;
+  } else if (!have_geometry_) {
+    throw std::runtime_error("Scan log frame without geometry");
+  }
+
+  frame.stamp_ns = last_stamp_;
+  frame.obs.max_range = max_range_;
+  frame.obs.angle_min = angle_min_;
+  frame.obs.angle_increment = angle_increment_;
+  frame.obs.ranges.resize(beams_);
+
+  std::int64_t q = 0;
+  for (double& range : frame.obs.ranges) {
+    q += unzigzag(r.varint());
+    if (q < 0) throw std::runtime_error("Malformed range in scan log");
+    range = q == 0 ? max_range_ : static_cast<double>(q - 1) * quantum_;
+  }
+
+  if (!r.done()) {
+    throw std::runtime_error("Trailing bytes in scan log frame");
+  }
+  return true;
+}
+
+} // namespace epistemic
@@ -0,0 +1,91 @@
+#include "epistemic/slam_events/scan_replay.hpp"
+#include "epistemic/del_update.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace epistemic {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Nearest-rank percentile of sorted samples
+double percentile(
+  const std::vector<double>& sorted,
+  double p
+) {
+  if (sorted.empty()) return 0.0;
+  const std::size_t rank = static_cast<std::size_t>(
+    std::ceil(p * static_cast<double>(sorted.size())));
+  return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+}
+
+} // namespace
+
+ReplayReport replay_scan_log(
+  ScanLogReader& reader,
+  BeliefState belief,
+  const ReplayOptions& options,
+  const std::function<void(const ScanFrame&, const BeliefState&)>& on_frame
+) {
+  ReplayReport report;
+  std::vector<double> latency;
+
+  // Without the map checks no lidar_bin precondition holds, so a bare
+  // product update would empty the belief on the first frame.
+  std::unique_ptr<ThreadPool> own_pool;
+  ThreadPool* pool = options.pool;
+  if (!pool) {
+    own_pool = std::make_unique<ThreadPool>();
+    pool = own_pool.get();
+  }
+
+  ScanFrame frame;
+  std::uint64_t first_stamp = 0;
+  const auto start = Clock::now();
+
+  while ((options.max_frames == 0 || latency.size() < options.max_frames) &&
+         reader.next(frame)) {
+
+    if (latency.empty()) first_stamp = frame.stamp_ns;
+
+    if (options.rate > 0.0) {
+      const double offset = static_cast<double>(frame.stamp_ns - first_stamp) * 1e-9;
+      std::this_thread::sleep_until(
+        start + std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(offset / options.rate)));
+    }
+
+    const auto t0 = Clock::now();
+    belief = lidar_update(belief, frame.obs, options.sensor, *pool, options.method);
+    renumber_worlds(belief);
+    latency.push_back(std::chrono::duration<double>(Clock::now() - t0).count());
+
+    if (on_frame) on_frame(frame, belief);
+  }
+
+  report.wall_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  report.frames = latency.size();
+  report.final_worlds = belief.model.worlds.size();
+
+  if (!latency.empty()) {
+    double sum = 0.0;
+    for (double l : latency) sum += l;
+    report.mean = sum / static_cast<double>(latency.size());
+
+    std::sort(latency.begin(), latency.end());
+    report.p50 = percentile(latency, 0.50);
+    report.p90 = percentile(latency, 0.90);
+    report.p99 = percentile(latency, 0.99);
+    report.max = latency.back();
+  }
+
+  return report;
+}
+
+} // namespace epistemic
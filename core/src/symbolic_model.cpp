@@ -0,0 +1,192 @@
+#include "epistemic/symbolic_model.hpp"
+
+#include <cmath>
+#include <variant>
+
+namespace epistemic {
+
+SymbolicModel::SymbolicModel(std::size_t state_vars)
+  : n_(state_vars) {
+
+  std::vector<BddVar> primed;
+  to_next_.resize(2 * n_);
+
+  for (std::size_t i = 0; i < n_; ++i) {
+    to_next_[2 * i] = static_cast<BddVar>(2 * i + 1);
+    to_next_[2 * i + 1] = static_cast<BddVar>(2 * i + 1);
+    primed.push_back(static_cast<BddVar>(2 * i + 1));
+  }
+
+  next_cube_ = bdd_.cube(primed);
+}
+
+BddRef SymbolicModel::current(std::size_t i) {
+  return bdd_.var(static_cast<BddVar>(2 * i));
+}
+
+BddRef SymbolicModel::next(std::size_t i) {
+  return bdd_.var(static_cast<BddVar>(2 * i + 1));
+}
+
+BddRef SymbolicModel::world(const std::vector<bool>& assignment) {
+  BddRef r = kBddTrue;
+  for (std::size_t i = 0; i < n_ && i < assignment.size(); ++i) {
+    const BddVar v = static_cast<BddVar>(2 * i);
+    r = bdd_.apply_and(r, assignment[i] ? bdd_.var(v) : bdd_.nvar(v));
+  }
+  return r;
+}
+
+void SymbolicModel::define_atom(const std::string& name, BddRef worlds) {
+  atoms_[name] = worlds;
+}
+
+void SymbolicModel::bind_atom(const std::string& name, std::size_t i) {
+  atoms_[name] = current(i);
+}
+
+void SymbolicModel::set_relation(Agent a, BddRef relation) {
+  if (a >= relations_.size()) relations_.resize(a + 1, kBddFalse);
+  relations_[a] = relation;
+}
+
+void SymbolicModel::set_observation_relation(
+  Agent a,
+  const std::vector<std::size_t>& observed
+) {
+  // ∧_{i ∈ observed} (x_i ↔ x'_i)
+  BddRef rel = kBddTrue;
+  for (std::size_t i : observed) {
+    const BddRef same = bdd_.ite(current(i), next(i), bdd_.negate(next(i)));
+    rel = bdd_.apply_and(rel, same);
+  }
+  set_relation(a, rel);
+}
+
+BddRef SymbolicModel::preimage(Agent a, BddRef set) {
+  if (a >= relations_.size() || relations_[a] == kBddFalse) {
+    return kBddFalse;
+  }
+
+  const BddRef set_next = bdd_.rename(set, to_next_);
+  return bdd_.and_exists(relations_[a], set_next, next_cube_);
+}
+
+BddRef SymbolicModel::knows(Agent a, BddRef phi_ext) {
+  // K_a φ = W ∧ ¬pre_a(W ∧ ¬φ)
+  const BddRef counter = bdd_.apply_and(domain_, bdd_.negate(phi_ext));
+  return bdd_.apply_and(domain_, bdd_.negate(preimage(a, counter)));
+}
+
+BddRef SymbolicModel::distributed(AgentMask group, BddRef phi_ext) {
+  // D_G φ = W ∧ ¬pre_G(W ∧ ¬φ) with R_G = ∧_{a ∈ G} R_a
+  BddRef relation = kBddTrue;
+  for_each_agent(group, [&](Agent a) {
+    relation = bdd_.apply_and(
+      relation,
+      a < relations_.size() ? relations_[a] : kBddFalse
+    );
+  });
+
+  const BddRef counter = bdd_.apply_and(domain_, bdd_.negate(phi_ext));
+  const BddRef pre = bdd_.and_exists(
+    relation,
+    bdd_.rename(counter, to_next_),
+    next_cube_
+  );
+  return bdd_.apply_and(domain_, bdd_.negate(pre));
+}
+
+BddRef SymbolicModel::extension(const Formula& phi) {
+  return std::visit([&](auto&& arg) -> BddRef {
+
+    using T = std::decay_t<decltype(arg)>;
+
+    if constexpr (std::is_same_v<T, Atom>) {
+      auto it = atoms_.find(arg.name);
+      if (it == atoms_.end()) return kBddFalse;
+      return bdd_.apply_and(domain_, it->second);
+    }
+
+    else if constexpr (std::is_same_v<T, Not>) {
+      return bdd_.apply_and(domain_, bdd_.negate(extension(*arg.phi)));
+    }
+
+    else if constexpr (std::is_same_v<T, And>) {
+      return bdd_.apply_and(extension(*arg.left), extension(*arg.right));
+    }
+
+    else if constexpr (std::is_same_v<T, Knows>) {
+      return knows(arg.agent, extension(*arg.phi));
+    }
+
+    else if constexpr (std::is_same_v<T, EverybodyKnows>) {
+      const BddRef sub = extension(*arg.phi);
+      BddRef r = domain_;
+      for_each_agent(arg.group, [&](Agent a) {
+        r = bdd_.apply_and(r, knows(a, sub));
+      });
+      return r;
+    }
+
+    // Reflexive-transitive reading, as in
+    // KripkeModel::evaluate_common_knowledge:
+    //   C_G φ = φ ∧ νZ. E_G(φ ∧ Z)
+    else if constexpr (std::is_same_v<T, CommonKnowledge>) {
+      const BddRef sub = extension(*arg.phi);
+
+      BddRef z = domain_;
+      for (;;) {
+        const BddRef target = bdd_.apply_and(sub, z);
+        BddRef next_z = domain_;
+        for_each_agent(arg.group, [&](Agent a) {
+          next_z = bdd_.apply_and(next_z, knows(a, target));
+        });
+        if (next_z == z) break;
+        z = next_z;
+      }
+      return bdd_.apply_and(sub, z);
+    }
+
+    else if constexpr (std::is_same_v<T, DistributedKnowledge>) {
+      return distributed(arg.group, extension(*arg.phi));
+    }
+
+    else {
+      return kBddFalse;
+    }
+
+  }, phi.value);
+}
+
+bool SymbolicModel::holds(
+  const std::vector<bool>& assignment,
+  const Formula& phi
+) {
+  std::vector<bool> full(2 * n_, false);
+  for (std::size_t i = 0; i < n_ && i < assignment.size(); ++i) {
+    full[2 * i] = assignment[i];
+  }
+  return bdd_.eval(extension(phi), full);
+}
+
+bool SymbolicModel::holds_in_all(BddRef designated, const Formula& phi) {
+  // designated ∩ W ⊆ [[φ]]
+  const BddRef outside = bdd_.apply_and(
+    bdd_.apply_and(designated, domain_),
+    bdd_.negate(extension(phi))
+  );
+  return outside == kBddFalse;
+}
+
+void SymbolicModel::public_announcement(const Formula& phi) {
+  domain_ = extension(phi);
+}
+
+long double SymbolicModel::world_count() {
+  // Interleaved order counts primed variables too; divide them out.
+  return bdd_.sat_count(domain_, static_cast<BddVar>(2 * n_)) /
+         std::pow(2.0L, static_cast<long double>(n_));
+}
+
+} // namespace epistemic
@@ -0,0 +1,112 @@
+#include "epistemic/thread_pool.hpp"
+
+namespace epistemic {
+
+namespace {
+
+// Identifies the pool and deque of the current worker thread, if any.
+thread_local const ThreadPool* tl_pool = nullptr;
+thread_local std::size_t tl_index = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t threads) {
+  if (threads == 0) threads = 1;
+
+  queues_.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+
+  workers_.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    workers_.emplace_back([this, i] { worker_loop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_cv_.notify_all();
+
+  for (auto& t : workers_) {
+    t.join();
+  }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+  const std::size_t index = (tl_pool == this)
+    ? tl_index
+    : next_queue_.fetch_add(1) % queues_.size();
+
+  pending_.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+    queues_[index]->tasks.push_back(std::move(task));
+  }
+  queued_.fetch_add(1);
+
+  // Empty critical section orders the increment before a sleeping
+  // worker re-checks its predicate, so the wakeup cannot be lost.
+  { std::lock_guard<std::mutex> lock(mutex_); }
+  work_cv_.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cv_.wait(lock, [&] { return pending_.load() == 0; });
+}
+
+bool ThreadPool::try_pop(std::size_t index, std::function<void()>& task) {
+  // Own deque: newest first
+  {
+    WorkerQueue& own = *queues_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+
+  // Steal: oldest first
+  for (std::size_t k = 1; k < queues_.size(); ++k) {
+    WorkerQueue& victim = *queues_[(index + k) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ThreadPool::worker_loop(std::size_t index) {
+  tl_pool = this;
+  tl_index = index;
+
+  for (;;) {
+    std::function<void()> task;
+
+    if (try_pop(index, task)) {
+      queued_.fetch_sub(1);
+      task();
+
+      if (pending_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_cv_.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    work_cv_.wait(lock, [&] { return stopping_ || queued_.load() > 0; });
+    if (stopping_ && queued_.load() == 0) return;
+  }
+}
+
+} // namespace epistemic
@@ -0,0 +1,374 @@
+#include "epistemic/typed_events.hpp"
+#include "epistemic/del_update.hpp"
+#include "epistemic/query.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
+
+namespace epistemic {
+
+namespace {
+
+using EventEdge = std::pair<std::size_t, std::size_t>;
+
+WorldId product_id(WorldId w, std::size_t e) {
+  return (w << 32) | static_cast<WorldId>(e);
+}
+
+Formula truth() {
+  return Formula{ Atom{ "true" } };
+}
+
+Formula negation(const Formula& phi) {
+  using Ptr = decltype(Not{}.phi);
+  return Formula{ Not{ Ptr(new Formula(phi)) } };
+}
+
+std::unordered_map<WorldId, const World*> index_worlds(const BeliefState& belief) {
+  std::unordered_map<WorldId, const World*> index;
+  for (const World& w : belief.model.worlds) index.emplace(w.id, &w);
+  return index;
+}
+
+void add_world(
+  BeliefState& updated,
+  const World& w,
+  std::size_t e
+) {
+  updated.model.worlds.push_back(w);
+  updated.model.worlds.back().id = product_id(w.id, e);
+  updated.designated.push_back(product_id(w.id, e));
+}
+
+/**
+ * Product with a per-agent partition of the events. Each precondition
+ * is checked once per designated world, and an edge (w1, w2) pairs
+ * only the events of w1 and w2 that share a class, by merging their
+ * class-sorted event lists.
+ */
+BeliefState partition_update(
+  const BeliefState& belief,
+  const std::vector<const Formula*>& preconditions,
+  const std::vector<std::vector<std::size_t>>& classes
+) {
+  const auto index = index_worlds(belief);
+
+  BeliefState updated;
+  std::unordered_map<WorldId, std::vector<std::size_t>> events_of;
+
+  for (WorldId w : belief.designated) {
+    auto it = index.find(w);
+    if (it == index.end() || events_of.count(w)) continue;
+
+    auto& events = events_of[w];
+    for (std::size_t e = 0; e < preconditions.size(); ++e) {
+      if (holds(belief, w, *preconditions[e])) {
+        events.push_back(e);
+        add_world(updated, *it->second, e);
+      }
+    }
+  }
+
+  const auto& accessibility = belief.model.accessibility;
+  updated.model.accessibility.resize(accessibility.size());
+
+  for (Agent a = 0; a < accessibility.size(); ++a) {
+    if (a >= classes.size() || classes[a].empty()) continue;
+    const auto& cls = classes[a];
+
+    // (class, event) per world, sorted by class
+    std::unordered_map<WorldId, std::vector<EventEdge>> by_class;
+    for (const auto& [w, events] : events_of) {
+      auto& list = by_class[w];
+      for (std::size_t e : events) list.push_back({cls[e], e});
+      std::sort(list.begin(), list.end());
+    }
+
+    auto& out = updated.model.accessibility[a];
+
+    for (const auto& [w1, w2] : accessibility[a]) {
+      auto l1 = by_class.find(w1);
+      auto l2 = by_class.find(w2);
+      if (l1 == by_class.end() || l2 == by_class.end()) continue;
+
+      const auto& x = l1->second;
+      const auto& y = l2->second;
+      std::size_t i = 0, j = 0;
+
+      while (i < x.size() && j < y.size()) {
+        if (x[i].first < y[j].first) { ++i; continue; }
+        if (y[j].first < x[i].first) { ++j; continue; }
+
+        const std::size_t c = x[i].first;
+        std::size_t j_end = j;
+        while (j_end < y.size() && y[j_end].first == c) ++j_end;
+
+        for (; i < x.size() && x[i].first == c; ++i) {
+          for (std::size_t k = j; k < j_end; ++k) {
+            out.push_back({product_id(w1, x[i].second), product_id(w2, y[k].second)});
+          }
+        }
+        j = j_end;
+      }
+    }
+  }
+
+  return updated;
+}
+
+std::vector<std::vector<std::size_t>> uniform_classes(
+  std::size_t agent_count,
+  std::size_t events,
+  AgentMask distinguishing
+) {
+  std::vector<std::vector<std::size_t>> classes(agent_count);
+  for (Agent a = 0; a < agent_count; ++a) {
+    classes[a].resize(events, 0);
+    if (distinguishing & agent_bit(a)) {
+      std::iota(classes[a].begin(), classes[a].end(), 0);
+    }
+  }
+  return classes;
+}
+
+EventModel partition_model(
+  std::vector<Formula> preconditions,
+  const std::vector<std::vector<std::size_t>>& classes
+) {
+  EventModel em;
+  for (std::size_t e = 0; e < preconditions.size(); ++e) {
+    em.events.push_back(Event{ e, std::move(preconditions[e]) });
+  }
+
+  em.accessibility.resize(classes.size());
+  for (Agent a = 0; a < classes.size(); ++a) {
+    for (std::size_t e1 = 0; e1 < classes[a].size(); ++e1) {
+      for (std::size_t e2 = 0; e2 < classes[a].size(); ++e2) {
+        if (classes[a][e1] == classes[a][e2]) em.add_edge(a, e1, e2);
+      }
+    }
+  }
+  return em;
+}
+
+/**
+ * Per-agent classes if every relation of E is an equivalence
+ * relation (or empty); false otherwise.
+ */
+bool partition_classes(
+  const EventModel& E,
+  std::size_t agent_count,
+  std::vector<std::vector<std::size_t>>& classes
+) {
+  const std::size_t n = E.events.size();
+  classes.assign(agent_count, {});
+
+  for (Agent a = 0; a < agent_count; ++a) {
+    const auto& rel = E.relation(a);
+    if (rel.empty()) continue;
+
+    std::set<EventEdge> edges(rel.begin(), rel.end());
+
+    // Class of e = smallest event it sees; then the relation must be
+    // exactly "same class".
+    auto& cls = classes[a];
+    cls.assign(n, n);
+    for (const auto& [e1, e2] : edges) {
+      if (e1 >= n || e2 >= n) return false;
+      cls[e1] = std::min(cls[e1], e2);
+    }
+
+    std::vector<std::size_t> class_size(n + 1, 0);
+    for (std::size_t e = 0; e < n; ++e) {
+      if (cls[e] == n) return false;  // not reflexive
+      ++class_size[cls[e]];
+    }
+
+    std::size_t expected = 0;
+    for (std::size_t s : class_size) expected += s * s;
+    if (expected != edges.size()) return false;
+
+    for (const auto& [e1, e2] : edges) {
+      if (cls[e1] != cls[e2]) return false;
+    }
+  }
+
+  return true;
+}
+
+bool is_truth(const Formula& phi) {
+  const Atom* atom = std::get_if<Atom>(&phi.value);
+  return atom && atom->name == "true";
+}
+
+} // namespace
+
+// ---- constructors -------------------------------------------------------
+
+PartitionEvent make_partition_event(
+  std::vector<Formula> preconditions,
+  AgentMask observers,
+  std::size_t agent_count
+) {
+  const std::size_t n = preconditions.size();
+  return PartitionEvent{
+    std::move(preconditions),
+    uniform_classes(agent_count, n, observers)
+  };
+}
+
+EventModel to_event_model(const PublicAnnouncementEvent& event, std::size_t agent_count) {
+  return partition_model({ event.phi }, uniform_classes(agent_count, 1, 0));
+}
+
+EventModel to_event_model(const PrivateAnnouncementEvent& event, std::size_t agent_count) {
+  EventModel em;
+  em.events.push_back(Event{ 0, event.phi });
+  em.events.push_back(Event{ 1, truth() });
+
+  for (Agent a = 0; a < agent_count; ++a) {
+    if (event.learners & agent_bit(a)) {
+      em.add_edge(a, 0, 0);
+    } else {
+      em.add_edge(a, 0, 1);
+    }
+    em.add_edge(a, 1, 1);
+  }
+  return em;
+}
+
+EventModel to_event_model(const SemiPrivateAnnouncementEvent& event, std::size_t agent_count) {
+  return partition_model(
+    { event.phi, negation(event.phi) },
+    uniform_classes(agent_count, 2, event.learners));
+}
+
+EventModel to_event_model(const PartitionEvent& event) {
+  return partition_model(event.preconditions, event.classes);
+}
+
+// ---- fast updates -------------------------------------------------------
+
+BeliefState update(const BeliefState& belief, const PublicAnnouncementEvent& event) {
+  // A one-event product only filters: no copies, ids kept.
+  return public_announcement(belief, event.phi);
+}
+
+BeliefState update(const BeliefState& belief, const SemiPrivateAnnouncementEvent& event) {
+  const Formula negated = negation(event.phi);
+  return partition_update(
+    belief, { &event.phi, &negated },
+    uniform_classes(belief.model.accessibility.size(), 2, event.learners));
+}
+
+BeliefState update(const BeliefState& belief, const PartitionEvent& event) {
+  std::vector<const Formula*> preconditions;
+  for (const Formula& phi : event.preconditions) preconditions.push_back(&phi);
+  return partition_update(belief, preconditions, event.classes);
+}
+
+BeliefState update(const BeliefState& belief, const PrivateAnnouncementEvent& event) {
+  const auto index = index_worlds(belief);
+
+  // Every designated world keeps a skip copy (w, 1); phi-worlds also
+  // get an announcement copy (w, 0).
+  BeliefState updated;
+  std::unordered_map<WorldId, bool> phi;
+
+  for (WorldId w : belief.designated) {
+    auto it = index.find(w);
+    if (it == index.end() || phi.count(w)) continue;
+
+    const bool value = holds(belief, w, event.phi);
+    phi.emplace(w, value);
+
+    if (value) add_world(updated, *it->second, 0);
+    add_world(updated, *it->second, 1);
+  }
+
+  const auto& accessibility = belief.model.accessibility;
+  updated.model.accessibility.resize(accessibility.size());
+
+  for (Agent a = 0; a < accessibility.size(); ++a) {
+    const bool learner = (event.learners & agent_bit(a)) != 0;
+    auto& out = updated.model.accessibility[a];
+
+    for (const auto& [w1, w2] : accessibility[a]) {
+      auto p1 = phi.find(w1);
+      auto p2 = phi.find(w2);
+      if (p1 == phi.end() || p2 == phi.end()) continue;
+
+      if (learner) {
+        if (p1->second && p2->second) out.push_back({product_id(w1, 0), product_id(w2, 0)});
+      } else {
+        if (p1->second) out.push_back({product_id(w1, 0), product_id(w2, 1)});
+      }
+      out.push_back({product_id(w1, 1), product_id(w2, 1)});
+    }
+  }
+
+  return updated;
+}
+
+// ---- shape detection ----------------------------------------------------
+
+EventShape detect_shape(
+  const EventModel& E,
+  std::size_t agent_count
+) {
+  std::vector<std::vector<std::size_t>> classes;
+  if (partition_classes(E, agent_count, classes)) {
+    return EventShape::Partition;
+  }
+
+  // Announcement event 0, skip event 1, as to_event_model builds it
+  if (E.events.size() != 2 || !is_truth(E.events[1].precondition)) {
+    return EventShape::General;
+  }
+
+  const std::set<EventEdge> learner{{0, 0}, {1, 1}};
+  const std::set<EventEdge> other{{0, 1}, {1, 1}};
+
+  for (Agent a = 0; a < agent_count; ++a) {
+    const auto& rel = E.relation(a);
+    const std::set<EventEdge> edges(rel.begin(), rel.end());
+    if (edges != learner && edges != other) return EventShape::General;
+  }
+
+  return EventShape::Private;
+}
+
+BeliefState update(
+  const BeliefState& belief,
+  const EventModel& E
+) {
+  const std::size_t agents = belief.model.accessibility.size();
+
+  // Fast paths assume event i has id i, as every constructor builds.
+  for (std::size_t i = 0; i < E.events.size(); ++i) {
+    if (E.events[i].id != i) return product_update(belief, E);
+  }
+
+  std::vector<std::vector<std::size_t>> classes;
+  if (partition_classes(E, agents, classes)) {
+    std::vector<const Formula*> preconditions;
+    for (const Event& e : E.events) preconditions.push_back(&e.precondition);
+    return partition_update(belief, preconditions, classes);
+  }
+
+  if (detect_shape(E, agents) == EventShape::Private) {
+    PrivateAnnouncementEvent event{ 0, E.events[0].precondition };
+    for (Agent a = 0; a < agents; ++a) {
+      if (E.accessible(a, 0, 0)) event.learners |= agent_bit(a);
+    }
+    return update(belief, event);
+  }
+
+  return product_update(belief, E);
+}
+
+} // namespace epistemic
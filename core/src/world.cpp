@@ -0,0 +1,254 @@
+#include "epistemic/world.hpp"
+#include "epistemic/quadtree_map.hpp"
+
+#include <atomic>
+#include <stdexcept>
+
+namespace epistemic {
+
+namespace {
+
+std::shared_ptr<const OccupancySums> build_sums(const GridMap& map) {
+  auto sums = std::make_shared<OccupancySums>();
+  sums->revision = map.revision();
+  sums->width = map.width;
+  sums->height = map.height;
+
+  const std::size_t stride = map.width + 1;
+  const std::size_t n = stride * (map.height + 1);
+  sums->free.assign(n, 0);
+  sums->unknown.assign(n, 0);
+
+  for (std::uint32_t y = 0; y < map.height; ++y) {
+    std::uint32_t row_free = 0;
+    std::uint32_t row_unknown = 0;
+
+    for (std::uint32_t x = 0; x < map.width; ++x) {
+      const CellState c = map.at(x, y);
+      row_free += c == CellState::Free;
+      row_unknown += c == CellState::Unknown;
+
+      const std::size_t i = (y + 1) * stride + (x + 1);
+      sums->free[i] = sums->free[i - stride] + row_free;
+      sums->unknown[i] = sums->unknown[i - stride] + row_unknown;
+    }
+  }
+
+  return sums;
+}
+
+std::uint64_t zobrist_cells(const std::vector<CellState>& cells) {
+  std::uint64_t z = 0;
+  for (std::size_t i = 0; i < cells.size(); ++i) {
+    z ^= GridMap::cell_key(i, cells[i]);
+  }
+  return z;
+}
+
+std::uint32_t rect_sum(
+  const std::vector<std::uint32_t>& table,
+  std::size_t stride,
+  std::uint32_t x0,
+  std::uint32_t y0,
+  std::uint32_t x1,
+  std::uint32_t y1
+) {
+  return table[(y1 + 1) * stride + (x1 + 1)]
+       - table[y0 * stride + (x1 + 1)]
+       - table[(y1 + 1) * stride + x0]
+       + table[y0 * stride + x0];
+}
+
+} // namespace
+
+void GridMap::reset(
+  std::uint32_t width,
+  std::uint32_t height,
+  double resolution,
+  CellState state
+) {
+  this->width = width;
+  this->height = height;
+  this->resolution = resolution;
+  cells_.assign(static_cast<std::size_t>(width) * height, state);
+  zobrist_ = zobrist_cells(cells_);
+  touch();
+}
+
+void GridMap::assign(
+  std::uint32_t width,
+  std::uint32_t height,
+  double resolution,
+  std::vector<CellState> cells
+) {
+  if (cells.size() != static_cast<std::size_t>(width) * height) {
+    throw std::invalid_argument("GridMap: cell count does not match shape");
+  }
+
+  this->width = width;
+  this->height = height;
+  this->resolution = resolution;
+  cells_ = std::move(cells);
+  zobrist_ = zobrist_cells(cells_);
+  touch();
+}
+
+void GridMap::fill(
+  std::size_t first,
+  std::size_t count,
+  CellState state
+) {
+  for (std::size_t i = first; i < first + count; ++i) {
+    zobrist_ ^= cell_key(i, cells_[i]) ^ cell_key(i, state);
+    cells_[i] = state;
+  }
+  touch();
+}
+
+void GridMap::touch() {
+  ++revision_;
+  edits_.clear();
+  edit_base_ = revision_;
+}
+
+std::uint64_t GridMap::hash() const {
+  // Fold the shape in so equal cell vectors of different shapes differ.
+  return zobrist_ ^ cell_key(
+    (static_cast<std::size_t>(width) << 32) | height, CellState::Unknown);
+}
+
+std::size_t GridMap::cell_bytes() const {
+  return cells_.capacity() * sizeof(CellState) +
+         edits_.capacity() * sizeof(std::uint32_t);
+}
+
+void GridMap::shrink_to_fit() {
+  cells_.shrink_to_fit();
+  edits_.shrink_to_fit();
+}
+
+std::size_t GridMap::cache_bytes() const {
+  std::size_t bytes = 0;
+
+  if (auto sums = std::atomic_load(&sums_)) {
+    bytes += sizeof(OccupancySums) +
+             (sums->free.capacity() + sums->unknown.capacity()) * sizeof(std::uint32_t);
+  }
+
+  if (auto slot = std::atomic_load(&field_)) {
+    bytes += sizeof(FieldSlot) + sizeof(DistanceField) +
+             slot->field->distance.capacity() * sizeof(float) +
+             slot->field->nearest.capacity() * sizeof(std::int32_t);
+  }
+
+  return bytes;
+}
+
+void GridMap::drop_caches() {
+  std::atomic_store(&sums_, std::shared_ptr<const OccupancySums>());
+  std::atomic_store(&field_, std::shared_ptr<const FieldSlot>());
+}
+
+bool GridMap::operator==(const GridMap& other) const {
+  if (width != other.width || height != other.height ||
+      resolution != other.resolution) {
+    return false;
+  }
+
+  // Cheap reject: the hashes are always current.
+  if (zobrist_ != other.zobrist_) {
+    return false;
+  }
+
+  return cells_ == other.cells_;
+}
+
+std::shared_ptr<const OccupancySums> GridMap::sums() const {
+  auto current = std::atomic_load(&sums_);
+  if (current && current->revision == revision_ &&
+      current->width == width && current->height == height) {
+    return current;
+  }
+
+  // Racing builders produce identical tables; last store wins.
+  auto fresh = build_sums(*this);
+  std::atomic_store(&sums_, fresh);
+  return fresh;
+}
+
+std::uint32_t GridMap::count(
+  std::uint32_t x0,
+  std::uint32_t y0,
+  std::uint32_t x1,
+  std::uint32_t y1,
+  CellState s
+) const {
+  const auto t = sums();
+  const std::size_t stride = width + 1;
+
+  const std::uint32_t free = rect_sum(t->free, stride, x0, y0, x1, y1);
+  const std::uint32_t unknown = rect_sum(t->unknown, stride, x0, y0, x1, y1);
+
+  switch (s) {
+    case CellState::Free: return free;
+    case CellState::Unknown: return unknown;
+    case CellState::Occupied: break;
+  }
+
+  const std::uint32_t area = (x1 - x0 + 1) * (y1 - y0 + 1);
+  return area - free - unknown;
+}
+
+bool GridMap::region_free(
+  std::uint32_t x0,
+  std::uint32_t y0,
+  std::uint32_t x1,
+  std::uint32_t y1
+) const {
+  return count(x0, y0, x1, y1, CellState::Free) ==
+         (x1 - x0 + 1) * (y1 - y0 + 1);
+}
+
+void World::store_map(MapStorage storage) {
+  if (storage == map_storage()) return;
+
+  if (storage == MapStorage::Quadtree) {
+    sparse_map = std::make_shared<const QuadtreeMap>(QuadtreeMap::from_dense(map));
+    map.reset(0, 0, map.resolution);
+    map.drop_caches();
+    map.shrink_to_fit();
+  } else {
+    map = sparse_map->to_dense();
+    sparse_map.reset();
+  }
+}
+
+const GridMap& World::dense_map(GridMap& scratch) const {
+  if (!sparse_map) return map;
+
+  scratch = sparse_map->to_dense();
+  return scratch;
+}
+
+bool World::operator==(const World& other) const {
+  if (!sparse_map && !other.sparse_map) {
+    return map == other.map && poses == other.poses && goals == other.goals;
+  }
+  if (map.resolution != other.map.resolution ||
+      poses != other.poses || goals != other.goals) {
+    return false;
+  }
+
+  if (sparse_map && other.sparse_map) {
+    return sparse_map == other.sparse_map || *sparse_map == *other.sparse_map;
+  }
+
+  // Mixed storage: the tree hash matches the dense one, so the fast
+  // reject still works; otherwise compare as trees.
+  const QuadtreeMap& tree = sparse_map ? *sparse_map : *other.sparse_map;
+  const GridMap& dense = sparse_map ? other.map : map;
+  return tree.hash() == dense.hash() &&
+         tree == QuadtreeMap::from_dense(dense);
+}
+
+} // namespace epistemic
@@ -0,0 +1,225 @@
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "std_msgs/msg/string.hpp"
+#include "std_msgs/msg/u_int64.hpp"
+#include "std_srvs/srv/trigger.hpp"
+
+#include "epistemic/formula_parser.hpp"
+#include "epistemic/planner.hpp"
+#include "epistemic/shm_belief.hpp"
+
+namespace epistemic_planner {
+
+namespace {
+
+std::size_t thread_count(std::size_t requested) {
+  return requested > 0 ? requested : std::thread::hardware_concurrency();
+}
+
+epistemic::SearchStrategy parse_strategy(const std::string& name) {
+  if (name == "bfs") return epistemic::SearchStrategy::BreadthFirst;
+  if (name == "astar") return epistemic::SearchStrategy::AStar;
+  if (name == "greedy") return epistemic::SearchStrategy::GreedyBestFirst;
+  throw std::invalid_argument(
+    "Unknown strategy '" + name + "' (expected bfs, astar or greedy)");
+}
+
+/** @throws std::invalid_argument if the value is negative */
+std::size_t size_parameter(
+  rclcpp::Node& node,
+  const std::string& name,
+  int default_value
+) {
+  const int value = node.declare_parameter<int>(name, default_value);
+  if (value < 0) {
+    throw std::invalid_argument(
+      "Parameter '" + name + "' must not be negative, got " + std::to_string(value));
+  }
+  return static_cast<std::size_t>(value);
+}
+
+} // namespace
+
+/**
+ * Thin ROS 2 wrapper around epistemic::Planner.
+ *
+ * The problem comes from parameters: `actions` (list of action specs,
+ * see epistemic::parse_action), `agents` (agent count for their event
+ * models) and `goal` (see epistemic::parse_formula). The goal can be replaced at run time
+ * on `~/goal`. The initial belief is read from the shared-memory
+ * region `belief_region` published by epistemic_state, whenever a
+ * sequence number arrives on `belief_seq_topic`. Code embedding
+ * the node can install all three through set_problem() instead.
+ *
+ * Calling the `~/plan` service runs the search and publishes the
+ * action names on `~/plan` as a space-separated string. The search
+ * runs on a copy of the problem, outside the lock, so goal and belief
+ * updates are not held up by it.
+ */
+class PlannerNode : public rclcpp::Node {
+public:
+  PlannerNode()
+    : Node("epistemic_planner"),
+      pool_(thread_count(size_parameter(*this, "threads", 0))) {
+
+    options_.max_depth = size_parameter(*this, "max_depth", 32);
+    options_.max_expansions = size_parameter(*this, "max_expansions", 100000);
+
+    options_.strategy = parse_strategy(
+      declare_parameter<std::string>("strategy", "bfs"));
+
+    const std::size_t agents = size_parameter(*this, "agents", 1);
+    std::vector<epistemic::Action> actions;
+    for (const std::string& spec :
+         declare_parameter<std::vector<std::string>>("actions", {})) {
+      actions.push_back(epistemic::parse_action(spec, agents));
+    }
+    planner_ = std::make_shared<epistemic::Planner>(std::move(actions), pool_);
+
+    const std::string goal = declare_parameter<std::string>("goal", "");
+    if (!goal.empty()) goal_ = epistemic::parse_formula(goal);
+
+    goal_sub_ = create_subscription<std_msgs::msg::String>(
+      "~/goal", 10,
+      [this](const std_msgs::msg::String::SharedPtr msg) {
+        try {
+          auto goal = epistemic::parse_formula(msg->data);
+          std::lock_guard<std::mutex> lock(mutex_);
+          goal_ = std::move(goal);
+        } catch (const std::invalid_argument& e) {
+          RCLCPP_WARN(get_logger(), "Ignoring goal: %s", e.what());
+        }
+      });
+
+    plan_pub_ = create_publisher<std_msgs::msg::String>("~/plan", 10);
+
+    // Optionally track the belief published by epistemic_state through
+    // shared memory instead of receiving it via set_problem().
+    const std::string region = declare_parameter<std::string>("belief_region", "");
+    const std::string seq_topic = declare_parameter<std::string>(
+      "belief_seq_topic", "/epistemic_state/belief_seq");
+    if (!region.empty()) {
+      region_name_ = region;
+      belief_seq_sub_ = create_subscription<std_msgs::msg::UInt64>(
+        seq_topic, 10,
+        [this](const std_msgs::msg::UInt64::SharedPtr) { load_shared_belief(); });
+    }
+
+    plan_srv_ = create_service<std_srvs::srv::Trigger>(
+      "~/plan",
+      [this](
+        const std::shared_ptr<std_srvs::srv::Trigger::Request>,
+        std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+        handle_plan(*response);
+      });
+  }
+
+  void set_problem(
+    epistemic::BeliefState initial,
+    std::vector<epistemic::Action> actions,
+    epistemic::Formula goal
+  ) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    initial_ = std::move(initial);
+    goal_ = std::move(goal);
+    planner_ = std::make_shared<epistemic::Planner>(std::move(actions), pool_);
+  }
+
+private:
+  void load_shared_belief() {
+    try {
+      // The region may not exist yet, or may be mid-creation; the next
+      // notification retries.
+      if (!subscriber_) {
+        subscriber_ = std::make_unique<epistemic::ShmBeliefSubscriber>(region_name_);
+      }
+
+      const auto view = subscriber_->latest();
+      if (!view) return;
+
+      auto belief = view->to_belief();
+      std::lock_guard<std::mutex> lock(mutex_);
+      initial_ = std::move(belief);
+    } catch (const std::runtime_error& e) {
+      // Also a snapshot overwritten mid-copy; the next notification
+      // brings a fresh one.
+      RCLCPP_DEBUG(get_logger(), "%s", e.what());
+    }
+  }
+
+  void handle_plan(std_srvs::srv::Trigger::Response& response) {
+    std::shared_ptr<const epistemic::Planner> planner;
+    std::optional<epistemic::BeliefState> initial;
+    std::optional<epistemic::Formula> goal;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      planner = planner_;
+      initial = initial_;
+      goal = goal_;
+    }
+
+    if (!planner || !initial || !goal) {
+      response.success = false;
+      response.message = "no planning problem set";
+      return;
+    }
+
+    epistemic::PlannerOptions options = options_;
+    if (options.strategy == epistemic::SearchStrategy::GreedyBestFirst) {
+      options.heuristic = epistemic::unsatisfied_worlds_heuristic(*goal);
+    }
+
+    const auto result = planner->plan(*initial, *goal, options);
+
+    response.success = result.found;
+    if (!result.found) {
+      response.message = "no plan within limits (expanded " +
+        std::to_string(result.expanded) + ")";
+      return;
+    }
+
+    std_msgs::msg::String msg;
+    for (std::size_t a : result.actions) {
+      if (!msg.data.empty()) msg.data += ' ';
+      msg.data += planner->actions()[a].name;
+    }
+    plan_pub_->publish(msg);
+
+    response.message = msg.data;
+  }
+
+  epistemic::ThreadPool pool_;
+  epistemic::PlannerOptions options_;
+
+  std::mutex mutex_;
+  // Shared so a running search keeps its planner when set_problem()
+  // replaces it.
+  std::shared_ptr<const epistemic::Planner> planner_;
+  std::optional<epistemic::BeliefState> initial_;
+  std::optional<epistemic::Formula> goal_;
+
+  std::string region_name_;
+  std::unique_ptr<epistemic::ShmBeliefSubscriber> subscriber_;
+
+  rclcpp::Publisher<std_msgs::msg::String>::SharedPtr plan_pub_;
+  rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr plan_srv_;
+  rclcpp::Subscription<std_msgs::msg::UInt64>::SharedPtr belief_seq_sub_;
+  rclcpp::Subscription<std_msgs::msg::String>::SharedPtr goal_sub_;
+};
+
+} // namespace epistemic_planner
+
+int main(int argc, char** argv) {
+  rclcpp::init(argc, argv);
+  rclcpp::spin(std::make_shared<epistemic_planner::PlannerNode>());
+  rclcpp::shutdown();
+  return 0;
+}
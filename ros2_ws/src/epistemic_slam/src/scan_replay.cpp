@@ -0,0 +1,263 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "epistemic/slam_events/scan_replay.hpp"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+void usage() {
+  std::fprintf(stderr,
+    "usage: scan_replay LOG [--rate R] [--frames N] [--worlds N] [--size CELLS]\n"
+    "                       [--field] [--sigma S]\n"
+    "       scan_replay --self-test\n"
+    "  --rate 0 (default) replays as fast as possible, 1 at recorded rate\n"
+    "  --self-test writes a synthetic log, reads it back and replays it\n");
+}
+
+/**
+ * Synthetic start belief: `worlds` hypotheses about the sensor's
+ * position in an unexplored square map, all indistinguishable to it.
+ */
+epistemic::BeliefState initial_belief(
+  std::size_t worlds,
+  std::uint32_t size
+) {
+  epistemic::BeliefState belief;
+  belief.model.accessibility.resize(1);
+
+  for (std::size_t i = 0; i < worlds; ++i) {
+    epistemic::World w;
+    w.id = i;
+    w.map.reset(size, size, 0.05);
+
+    const double center = 0.5 * size * w.map.resolution;
+    w.poses[0] = {center + 0.1 * static_cast<double>(i), center, 0.0};
+
+    belief.model.worlds.push_back(std::move(w));
+    belief.designated.push_back(i);
+  }
+
+  for (std::size_t i = 0; i < worlds; ++i) {
+    for (std::size_t j = 0; j < worlds; ++j) {
+      belief.model.accessibility[0].push_back({i, j});
+    }
+  }
+
+  return belief;
+}
+
+/**
+ * Synthetic frames: a noisy room with some missing returns, a stamp
+ * that goes backwards once and a geometry change halfway, where the
+ * beam count doubles.
+ */
+std::vector<epistemic::ScanFrame> synthetic_frames(
+  std::size_t count,
+  std::size_t beams
+) {
+  std::vector<epistemic::ScanFrame> frames(count);
+  std::uint64_t stamp = 1'000'000'000;
+
+  for (std::size_t f = 0; f < count; ++f) {
+    epistemic::ScanFrame& frame = frames[f];
+    const bool wide = f >= count / 2;
+
+    stamp = f == 3 ? stamp - 5'000'000 : stamp + 100'000'000 + 37 * f;
+    frame.stamp_ns = stamp;
+    frame.obs.max_range = wide ? 12.0 : 8.0;
+    frame.obs.angle_min = wide ? -kPi : -kPi / 2;
+    frame.obs.angle_increment = wide ? kPi / beams : kPi / (2 * beams);
+    frame.obs.ranges.resize(wide ? 2 * beams : beams);
+
+    for (std::size_t i = 0; i < frame.obs.ranges.size(); ++i) {
+      double& r = frame.obs.ranges[i];
+      r = 2.0 + std::sin(0.05 * static_cast<double>(i + f)) + 0.0007 * ((i * 7919 + f) % 13);
+      if ((i + f) % 17 == 0) r = 0.0;
+      if ((i + f) % 23 == 0) r = frame.obs.max_range + 1.0;
+      if ((i + f) % 29 == 0) r = std::nan("");
+    }
+  }
+  return frames;
+}
+
+/**
+ * Round trip through ScanLogWriter / ScanLogReader, then a replay of
+ * the decoded log checking that world ids stay unique. Prints the
+ * first failure and returns the process exit code.
+ */
+int self_test() {
+  const double quantum = 0.001;
+  const auto frames = synthetic_frames(12, 181);
+
+  std::stringstream log;
+  {
+    epistemic::ScanLogWriter writer(log, quantum);
+    for (const auto& frame : frames) writer.write(frame);
+  }
+
+  try {
+    epistemic::ScanLogReader reader(log);
+    epistemic::ScanFrame decoded;
+
+    for (std::size_t f = 0; f < frames.size(); ++f) {
+      const epistemic::LidarObservation& obs = frames[f].obs;
+
+      if (!reader.next(decoded)) {
+        std::fprintf(stderr, "self-test: log ends after %zu of %zu frames\n", f, frames.size());
+        return 1;
+      }
+      if (decoded.stamp_ns != frames[f].stamp_ns ||
+          decoded.obs.max_range != obs.max_range ||
+          decoded.obs.angle_min != obs.angle_min ||
+          decoded.obs.angle_increment != obs.angle_increment ||
+          decoded.obs.ranges.size() != obs.ranges.size()) {
+        std::fprintf(stderr, "self-test: frame %zu header differs\n", f);
+        return 1;
+      }
+
+      for (std::size_t i = 0; i < obs.ranges.size(); ++i) {
+        const double r = obs.ranges[i];
+        const bool missing = !std::isfinite(r) || r <= 0.0 || r >= obs.max_range;
+        const double expected = missing ? obs.max_range : r;
+        const double tolerance = missing ? 0.0 : quantum / 2 + 1e-12;
+
+        if (std::abs(decoded.obs.ranges[i] - expected) > tolerance) {
+          std::fprintf(stderr, "self-test: frame %zu beam %zu decodes %.6f, expected %.6f\n",
+                       f, i, decoded.obs.ranges[i], expected);
+          return 1;
+        }
+      }
+    }
+    if (reader.next(decoded)) {
+      std::fprintf(stderr, "self-test: extra frame after %zu\n", frames.size());
+      return 1;
+    }
+
+    // Every frame multiplies the worlds by its beam count, so the
+    // replay runs on a few narrow scans. Only missing returns agree
+    // with the unexplored start maps.
+    std::stringstream replay_log;
+    {
+      epistemic::ScanLogWriter writer(replay_log, quantum);
+      for (auto frame : synthetic_frames(4, 2)) {
+        for (double& r : frame.obs.ranges) r = 0.0;
+        writer.write(frame);
+      }
+    }
+    epistemic::ScanLogReader replay_reader(replay_log);
+
+    epistemic::ReplayOptions options;
+
+    std::string failure;
+    std::size_t replayed = 0;
+    epistemic::replay_scan_log(
+      replay_reader, initial_belief(3, 40), options,
+      [&](const epistemic::ScanFrame&, const epistemic::BeliefState& belief) {
+        ++replayed;
+        if (belief.model.worlds.empty() && failure.empty()) {
+          failure = "no worlds left after frame " + std::to_string(replayed);
+        }
+        std::set<epistemic::WorldId> ids;
+        for (const auto& w : belief.model.worlds) {
+          if (!ids.insert(w.id).second && failure.empty()) {
+            failure = "duplicate world id " + std::to_string(w.id) +
+                      " after frame " + std::to_string(replayed);
+          }
+        }
+        for (epistemic::WorldId w : belief.designated) {
+          if (!ids.count(w) && failure.empty()) {
+            failure = "designated world " + std::to_string(w) +
+                      " missing after frame " + std::to_string(replayed);
+          }
+        }
+      });
+
+    if (!failure.empty()) {
+      std::fprintf(stderr, "self-test: %s\n", failure.c_str());
+      return 1;
+    }
+    if (replayed != 4) {
+      std::fprintf(stderr, "self-test: replayed %zu of 4 frames\n", replayed);
+      return 1;
+    }
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "self-test: %s\n", e.what());
+    return 1;
+  }
+
+  std::printf("self-test     ok (%zu frames, %zu bytes)\n", frames.size(), log.str().size());
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    usage();
+    return 2;
+  }
+  if (std::strcmp(argv[1], "--self-test") == 0) {
+    if (argc != 2) {
+      usage();
+      return 2;
+    }
+    return self_test();
+  }
+
+  epistemic::ReplayOptions options;
+  std::size_t worlds = 8;
+  std::uint32_t size = 200;
+
+  for (int i = 2; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+
+    if (arg == "--rate" && has_value) options.rate = std::atof(argv[++i]);
+    else if (arg == "--frames" && has_value) options.max_frames = std::strtoull(argv[++i], nullptr, 10);
+    else if (arg == "--worlds" && has_value) worlds = std::strtoull(argv[++i], nullptr, 10);
+    else if (arg == "--size" && has_value) size = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    else if (arg == "--sigma" && has_value) options.sensor.sigma = std::atof(argv[++i]);
+    else if (arg == "--field") options.method = epistemic::ScanMethod::LikelihoodField;
+    else {
+      usage();
+      return 2;
+    }
+  }
+
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in) {
+    std::fprintf(stderr, "scan_replay: cannot open %s\n", argv[1]);
+    return 1;
+  }
+
+  try {
+    epistemic::ScanLogReader reader(in);
+    const auto report = epistemic::replay_scan_log(
+      reader, initial_belief(worlds, size), options);
+
+    std::printf("frames        %zu\n", report.frames);
+    std::printf("wall          %.3f s (%.1f frames/s)\n",
+                report.wall_seconds, report.frames_per_second());
+    std::printf("latency mean  %.3f ms\n", report.mean * 1e3);
+    std::printf("latency p50   %.3f ms\n", report.p50 * 1e3);
+    std::printf("latency p90   %.3f ms\n", report.p90 * 1e3);
+    std::printf("latency p99   %.3f ms\n", report.p99 * 1e3);
+    std::printf("latency max   %.3f ms\n", report.max * 1e3);
+    std::printf("final worlds  %zu\n", report.final_worlds);
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "scan_replay: %s\n", e.what());
+    return 1;
+  }
+
+  return 0;
+}
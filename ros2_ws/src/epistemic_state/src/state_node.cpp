@@ -0,0 +1,155 @@
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "std_msgs/msg/string.hpp"
+#include "std_msgs/msg/u_int64.hpp"
+#include "std_msgs/msg/u_int8_multi_array.hpp"
+
+#include "epistemic/belief_delta.hpp"
+#include "epistemic/del_update.hpp"
+#include "epistemic/memory.hpp"
+#include "epistemic/planner.hpp"
+#include "epistemic/shm_belief.hpp"
+
+namespace epistemic_state {
+
+/**
+ * Owns the current belief and shares it with co-located nodes.
+ *
+ * The belief starts empty and changes through two topics:
+ *  - `~/delta` carries encode_delta bytes, applied with digest checks.
+ *    The first delta, diffed against an empty belief, seeds the state.
+ *  - `~/update` carries an action spec (see epistemic::parse_action,
+ *    with the `agents` parameter), applied by product update.
+ * Code embedding the node can also replace the belief via set_belief().
+ *
+ * Every new belief is written into the shared-memory region named by
+ * the `region` parameter and the publication count is announced on
+ * `~/belief_seq`. Readers map the region and read in place; only the
+ * 8-byte sequence number goes over DDS.
+ *
+ * With `max_belief_bytes` set, each belief is first brought under that
+ * budget by enforce_budget (compaction and merging, then pruning unless
+ * `allow_prune` is false). The budgeted belief is the one kept, so after
+ * pruning, senders must diff against the published state.
+ */
+class StateNode : public rclcpp::Node {
+public:
+  StateNode()
+    : Node("epistemic_state"),
+      publisher_(
+        declare_parameter<std::string>("region", "/epistemic_belief"),
+        static_cast<std::size_t>(
+          declare_parameter<int>("slot_capacity", 64 << 20))) {
+
+    const int max_bytes = declare_parameter<int>("max_belief_bytes", 0);
+    if (max_bytes < 0) {
+      throw std::invalid_argument("max_belief_bytes must not be negative");
+    }
+    budget_.max_bytes = static_cast<std::size_t>(max_bytes);
+    budget_.allow_prune = declare_parameter<bool>("allow_prune", true);
+
+    const int agents = declare_parameter<int>("agents", 1);
+    if (agents < 0) {
+      throw std::invalid_argument("agents must not be negative");
+    }
+    agents_ = static_cast<std::size_t>(agents);
+
+    publisher_.set_unlink_on_close(true);
+    seq_pub_ = create_publisher<std_msgs::msg::UInt64>("~/belief_seq", 10);
+
+    delta_sub_ = create_subscription<std_msgs::msg::UInt8MultiArray>(
+      "~/delta", 10,
+      [this](const std_msgs::msg::UInt8MultiArray::SharedPtr msg) {
+        handle_delta(msg->data);
+      });
+
+    update_sub_ = create_subscription<std_msgs::msg::String>(
+      "~/update", 10,
+      [this](const std_msgs::msg::String::SharedPtr msg) {
+        handle_update(msg->data);
+      });
+  }
+
+  void set_belief(epistemic::BeliefState belief) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    publish_locked(std::move(belief));
+  }
+
+private:
+  void handle_delta(const std::vector<std::uint8_t>& bytes) {
+    try {
+      const auto delta = epistemic::decode_delta(bytes.data(), bytes.size());
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      // Checks the base and target digests; belief_ is untouched on failure.
+      epistemic::apply_delta(belief_, delta);
+      publish_locked(belief_);
+    } catch (const std::runtime_error& e) {
+      RCLCPP_WARN(get_logger(), "Ignoring belief delta: %s", e.what());
+    }
+  }
+
+  void handle_update(const std::string& spec) {
+    epistemic::Action action;
+    try {
+      action = epistemic::parse_action(spec, agents_);
+    } catch (const std::invalid_argument& e) {
+      RCLCPP_WARN(get_logger(), "Ignoring update: %s", e.what());
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto next = epistemic::product_update(belief_, action.event);
+    epistemic::renumber_worlds(next);
+    publish_locked(std::move(next));
+  }
+
+  void publish_locked(epistemic::BeliefState belief) {
+    if (budget_.max_bytes != 0) {
+      const auto result = epistemic::enforce_budget(belief, budget_);
+      if (result.pruned_worlds != 0) {
+        RCLCPP_INFO(
+          get_logger(), "Pruned %zu worlds to fit the belief budget",
+          result.pruned_worlds);
+      }
+      if (!result.within_budget) {
+        RCLCPP_WARN(
+          get_logger(), "Belief uses %zu bytes, over the %zu byte budget",
+          result.after.total(), budget_.max_bytes);
+      }
+    }
+
+    publisher_.publish(belief);
+    belief_ = std::move(belief);
+
+    std_msgs::msg::UInt64 msg;
+    msg.data = publisher_.publications();
+    seq_pub_->publish(msg);
+  }
+
+  std::mutex mutex_;
+  epistemic::BeliefState belief_;
+  epistemic::MemoryBudget budget_;
+  std::size_t agents_ = 1;
+  epistemic::ShmBeliefPublisher publisher_;
+
+  rclcpp::Publisher<std_msgs::msg::UInt64>::SharedPtr seq_pub_;
+  rclcpp::Subscription<std_msgs::msg::UInt8MultiArray>::SharedPtr delta_sub_;
+  rclcpp::Subscription<std_msgs::msg::String>::SharedPtr update_sub_;
+};
+
+} // namespace epistemic_state
+
+int main(int argc, char** argv) {
+  rclcpp::init(argc, argv);
+  rclcpp::spin(std::make_shared<epistemic_state::StateNode>());
+  rclcpp::shutdown();
+  return 0;
+}